@@ -5,6 +5,23 @@
 class IEncoder
 {
 public:
+  //what writeFrame does when all pooled frames are waiting for the encoding thread
+  enum class Overflow
+  {
+    BLOCK,
+    DROP
+  };
+
+  struct Stats
+  {
+    uint64_t framesWritten;
+    uint64_t framesDropped;
+    uint64_t framesBlocked;
+    uint64_t framesRepeated;
+    uint64_t audioFramesDropped;
+    uint64_t audioConvertMicroseconds;
+  };
+
   virtual ~IEncoder() = default;
 
   virtual uint32_t width() const = 0;
@@ -13,7 +30,13 @@ public:
 
   virtual void startEncoding( int fpsNumerator, int fpsDenominator ) = 0;
   virtual bool writeFrame( uint8_t const* y, int ystride, uint8_t const* u, int ustride, uint8_t const* v, int vstride ) = 0;
+  //native SCREEN_WIDTH x SCREEN_HEIGHT frame of 12-bit Lynx colors 0x0GBR. Conversion and scaling is done by the encoder
+  virtual bool writeNativeFrame( uint16_t const* colors ) = 0;
+  //previous frame is shown for one more frame period. Returns false if there is no previous frame
+  virtual bool repeatFrame() = 0;
   virtual void pushAudioBuffer( std::span<float const> buf ) = 0;
+  virtual void setOverflow( Overflow overflow ) = 0;
+  virtual Stats stats() const = 0;
 };
 
 #ifdef ENCODER_EXPORTS
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <emmintrin.h>
+
+//Single producer single consumer ring buffer of interleaved stereo frames.
+//Producer is the audio thread, consumer is the encoding thread.
+class AudioRing
+{
+public:
+  //about 1.4 s at 48 kHz
+  static constexpr size_t CAPACITY = 1 << 16;
+
+  AudioRing() : mData{}, mHead{}, mTail{}
+  {
+  }
+
+  //returns number of frames that did not fit
+  size_t push( std::span<float const> interleaved )
+  {
+    size_t frames = interleaved.size() / 2;
+    uint64_t head = mHead.load( std::memory_order_relaxed );
+    uint64_t tail = mTail.load( std::memory_order_acquire );
+
+    size_t free = CAPACITY - (size_t)( head - tail );
+    size_t count = std::min( frames, free );
+
+    size_t offset = head & MASK;
+    size_t first = std::min( count, CAPACITY - offset );
+    std::memcpy( &mData[offset * 2], interleaved.data(), first * 2 * sizeof( float ) );
+    std::memcpy( &mData[0], interleaved.data() + first * 2, ( count - first ) * 2 * sizeof( float ) );
+
+    mHead.store( head + count, std::memory_order_release );
+    return frames - count;
+  }
+
+  size_t available() const
+  {
+    return (size_t)( mHead.load( std::memory_order_acquire ) - mTail.load( std::memory_order_relaxed ) );
+  }
+
+  //de-interleaves exactly count frames into planar buffers. Returns false if there is not enough data
+  bool pop( float* left, float* right, size_t count )
+  {
+    uint64_t tail = mTail.load( std::memory_order_relaxed );
+    uint64_t head = mHead.load( std::memory_order_acquire );
+
+    if ( head - tail < count )
+      return false;
+
+    size_t offset = tail & MASK;
+    size_t first = std::min( count, CAPACITY - offset );
+    deinterleave( &mData[offset * 2], left, right, first );
+    deinterleave( &mData[0], left + first, right + first, count - first );
+
+    mTail.store( tail + count, std::memory_order_release );
+    return true;
+  }
+
+private:
+  static void deinterleave( float const* src, float* left, float* right, size_t count )
+  {
+    size_t i = 0;
+    for ( ; i + 4 <= count; i += 4 )
+    {
+      __m128 lo = _mm_loadu_ps( src + i * 2 );
+      __m128 hi = _mm_loadu_ps( src + i * 2 + 4 );
+      _mm_storeu_ps( left + i, _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+      _mm_storeu_ps( right + i, _mm_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+    }
+    for ( ; i < count; ++i )
+    {
+      left[i] = src[i * 2 + 0];
+      right[i] = src[i * 2 + 1];
+    }
+  }
+
+private:
+  static constexpr size_t MASK = CAPACITY - 1;
+
+  std::array<float, CAPACITY * 2> mData;
+  alignas( 64 ) std::atomic<uint64_t> mHead;
+  alignas( 64 ) std::atomic<uint64_t> mTail;
+};
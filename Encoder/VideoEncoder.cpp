@@ -1,9 +1,13 @@
 #include "VideoEncoder.hpp"
 #include "Ex.hpp"
 #include "Utility.hpp"
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 
-VideoEncoder::VideoEncoder( std::filesystem::path const& path, int vbitrate, int abitrate, int width, int height ) : mPath{ path }, mVbitrate{ vbitrate }, mAbitrate{ abitrate }, mFormatContext{}, mAudioCodec{}, mVideoCodec{}, mWidth{ width }, mHeight{ height }, mMutex{}
+VideoEncoder::VideoEncoder( std::filesystem::path const& path, int vbitrate, int abitrate, int width, int height ) : mPath{ path }, mVbitrate{ vbitrate }, mAbitrate{ abitrate }, mFormatContext{}, mAudioCodec{}, mVideoCodec{}, mWidth{ width }, mHeight{ height }, mYUVLut{ makeYUVLut() }, mAudioRing{}, mAudioFramesDropped{}, mAudioConvertNanoseconds{},
+  mFramePool{}, mFreeFrames{}, mPendingFrames{}, mNextVideoPts{}, mFrameMutex{}, mFrameCV{}, mEncodingThread{}, mError{}, mFinish{}, mOverflow{ Overflow::BLOCK }, mFramesWritten{}, mFramesDropped{}, mFramesBlocked{}, mFramesRepeated{}
 {
 }
 
@@ -12,8 +16,26 @@ VideoEncoder::~VideoEncoder()
   if ( !mFormatContext )
     return;
 
-  pushFrame( &*mVideoStream->encoder, mVideoStream->st, nullptr );
-  pushFrame( &*mAudioStream->encoder, mAudioStream->st, nullptr );
+  {
+    std::scoped_lock<std::mutex> l{ mFrameMutex };
+    mFinish = true;
+  }
+  mFrameCV.notify_all();
+
+  if ( mEncodingThread.joinable() )
+    mEncodingThread.join();
+
+  //destructor must not throw, the file is closed anyway
+  try
+  {
+    rethrowError();
+    pushFrame( &*mVideoStream->encoder, mVideoStream->st, nullptr );
+    pushFrame( &*mAudioStream->encoder, mAudioStream->st, nullptr );
+  }
+  catch ( std::exception const& ex )
+  {
+    av_log( nullptr, AV_LOG_ERROR, "Encoding %s failed: %s\n", mPath.string().c_str(), ex.what() );
+  }
 
 
   /* Write the trailer, if any. The trailer must be written before you
@@ -31,12 +53,19 @@ VideoEncoder::~VideoEncoder()
 
 void VideoEncoder::pushAudioBuffer( std::span<float const> buf )
 {
-  std::scoped_lock<std::mutex> l{ mMutex };
+  mAudioFramesDropped += mAudioRing.push( buf );
+}
 
-  for ( float sample : buf )
-  {
-    mAudioQueue.push( sample );
-  }
+void VideoEncoder::setOverflow( Overflow overflow )
+{
+  std::scoped_lock<std::mutex> l{ mFrameMutex };
+  mOverflow = overflow;
+}
+
+IEncoder::Stats VideoEncoder::stats() const
+{
+  return Stats{ mFramesWritten.load(), mFramesDropped.load(), mFramesBlocked.load(), mFramesRepeated.load(), mAudioFramesDropped.load(),
+    mAudioConvertNanoseconds.load() / 1000 };
 }
 
 void VideoEncoder::startEncoding( int fpsNumerator, int fpsDenominator )
@@ -73,6 +102,11 @@ void VideoEncoder::startEncoding( int fpsNumerator, int fpsDenominator )
     av_strerror( ret, errbuf, AV_ERROR_MAX_STRING_SIZE );
     throw Ex{} << "Error occurred when opening output file" << errbuf;
   }
+
+  mEncodingThread = std::thread{ [this]
+  {
+    encodingLoop();
+  } };
 }
 
 uint32_t VideoEncoder::width() const
@@ -338,7 +372,11 @@ void VideoEncoder::openVideo( int width, int height, int bitrate, AVRational fps
     throw Ex{} << "Could not open video codec: " << errbuf;
   }
 
-  mVideoStream->frame = allocVideoFrame( mVideoStream->encoder->pix_fmt, mVideoStream->encoder->width, mVideoStream->encoder->height );
+  for ( size_t i = 0; i < FRAME_POOL_SIZE; ++i )
+  {
+    mFramePool.push_back( allocVideoFrame( mVideoStream->encoder->pix_fmt, mVideoStream->encoder->width, mVideoStream->encoder->height ) );
+    mFreeFrames.push_back( &*mFramePool.back() );
+  }
 
   /* If the output format is not YUV420P, then a temporary YUV420P
    * picture is needed too. It is then converted to the required
@@ -352,65 +390,277 @@ void VideoEncoder::openVideo( int width, int height, int bitrate, AVRational fps
 }
 
 /*
- * encode one video frame and send it to the muxer
- * return 1 when encoding is finished, 0 otherwise
+ * copy one video frame to a pooled frame and queue it for the encoding thread
+ * return false when encoding is not started yet
  */
 bool VideoEncoder::writeFrame( uint8_t const* y, int ystride, uint8_t const* u, int ustride, uint8_t const* v, int vstride )
 {
   if ( !mFormatContext )
     return false;
 
+  //the frame keeps its time slot even if dropped, so the previous frame is just shown longer
+  int64_t pts = mNextVideoPts++;
+
+  auto frame = acquireFrame();
+  if ( !frame )
+  {
+    mFramesDropped += 1;
+    return true;
+  }
+
   /* when we pass a frame to the encoder, it may keep a reference to it
    * internally; make sure we do not overwrite it here */
-  if ( av_frame_make_writable( &*mVideoStream->frame ) < 0 )
+  if ( av_frame_make_writable( frame.get() ) < 0 )
     throw Ex{};
 
   int height = mVideoStream->encoder->height;
 
-  size_t ysize = mVideoStream->frame->linesize[0];
+  size_t ysize = frame->linesize[0];
   for ( size_t i = 0; i < height; ++i )
   {
-    memcpy( mVideoStream->frame->data[0] + i * ysize, y + i * ystride, ysize );
+    memcpy( frame->data[0] + i * ysize, y + i * ystride, ysize );
   }
 
-  size_t usize = mVideoStream->frame->linesize[1];
-  size_t vsize = mVideoStream->frame->linesize[2];
+  size_t usize = frame->linesize[1];
+  size_t vsize = frame->linesize[2];
   for ( size_t i = 0; i < height / 2; ++i )
   {
-    memcpy( mVideoStream->frame->data[1] + i * usize, u + i * ustride, usize );
-    memcpy( mVideoStream->frame->data[2] + i * vsize, v + i * vstride, vsize );
+    memcpy( frame->data[1] + i * usize, u + i * ustride, usize );
+    memcpy( frame->data[2] + i * vsize, v + i * vstride, vsize );
+  }
+
+  frame->pts = pts;
+  queueFrame( frame );
+
+  return true;
+}
+
+/*
+ * convert native frame straight into a pooled frame.
+ * Source pixel is scaled to vscale x vscale luma block, and as vscale is even, to exactly vscale/2 x vscale/2 chroma block,
+ * so chroma needs no averaging. Each destination line is built once and then replicated.
+ */
+bool VideoEncoder::writeNativeFrame( uint16_t const* colors )
+{
+  if ( !mFormatContext )
+    return false;
+
+  int64_t pts = mNextVideoPts++;
+
+  auto frame = acquireFrame();
+  if ( !frame )
+  {
+    mFramesDropped += 1;
+    return true;
   }
 
-  mVideoStream->frame->pts = mVideoStream->nextPts++;
+  if ( av_frame_make_writable( frame.get() ) < 0 )
+    throw Ex{};
 
-  pushFrame( &*mVideoStream->encoder, mVideoStream->st, &*mVideoStream->frame );
+  size_t const scale = vscale();
+  size_t const cscale = scale / 2;
+  size_t const width = SCREEN_WIDTH * scale;
+  size_t const cwidth = SCREEN_WIDTH * cscale;
 
-  while ( av_compare_ts( mVideoStream->nextPts, mVideoStream->encoder->time_base, mAudioStream->nextPts, mAudioStream->encoder->time_base ) > 0 )
+  for ( size_t row = 0; row < SCREEN_HEIGHT; ++row )
   {
-    int ret = av_frame_make_writable( &*mAudioStream->frame );
-    if ( ret < 0 )
-      throw Ex{};
+    uint16_t const* src = colors + row * SCREEN_WIDTH;
+    uint8_t* y = frame->data[0] + row * scale * frame->linesize[0];
+    uint8_t* u = frame->data[1] + row * cscale * frame->linesize[1];
+    uint8_t* v = frame->data[2] + row * cscale * frame->linesize[2];
+
+    for ( size_t x = 0; x < SCREEN_WIDTH; ++x )
+    {
+      uint32_t yuv = mYUVLut[src[x] & 0xfff];
+      std::memset( y + x * scale, (uint8_t)yuv, scale );
+      std::memset( u + x * cscale, (uint8_t)( yuv >> 8 ), cscale );
+      std::memset( v + x * cscale, (uint8_t)( yuv >> 16 ), cscale );
+    }
+
+    for ( size_t i = 1; i < scale; ++i )
+    {
+      std::memcpy( y + i * frame->linesize[0], y, width );
+    }
+
+    for ( size_t i = 1; i < cscale; ++i )
+    {
+      std::memcpy( u + i * frame->linesize[1], u, cwidth );
+      std::memcpy( v + i * frame->linesize[2], v, cwidth );
+    }
+  }
+
+  frame->pts = pts;
+  queueFrame( frame );
+
+  return true;
+}
+
+/*
+ * nothing is encoded, the gap in pts makes the muxer show the previous frame longer.
+ * The slot is still queued so that the encoding thread encodes audio up to it
+ */
+bool VideoEncoder::repeatFrame()
+{
+  if ( !mFormatContext || mNextVideoPts == 0 )
+    return false;
 
-    std::scoped_lock<std::mutex> l{ mMutex };
+  {
+    std::scoped_lock<std::mutex> l{ mFrameMutex };
+    rethrowError();
+  }
+
+  enqueue( PendingFrame{ nullptr, mNextVideoPts++ } );
+  mFramesRepeated += 1;
+  return true;
+}
+
+void VideoEncoder::queueFrame( PooledFrame frame )
+{
+  int64_t pts = frame->pts;
+  enqueue( PendingFrame{ frame.release(), pts } );
+
+  mFramesWritten += 1;
+}
+
+void VideoEncoder::enqueue( PendingFrame pending )
+{
+  {
+    std::scoped_lock<std::mutex> l{ mFrameMutex };
+    mPendingFrames.push_back( pending );
+  }
+  mFrameCV.notify_all();
+}
+
+std::array<uint32_t, 4096> VideoEncoder::makeYUVLut()
+{
+  std::array<uint32_t, 4096> result{};
+
+  //the same BT.601 limited range coefficients as renderYUV.csh
+  for ( uint32_t color = 0; color < result.size(); ++color )
+  {
+    double r = ( color & 0xf ) / 15.0;
+    double b = ( ( color >> 4 ) & 0xf ) / 15.0;
+    double g = ( ( color >> 8 ) & 0xf ) / 15.0;
+
+    double y =  0.257 * r + 0.504 * g + 0.098 * b + 0.0625;
+    double u = -0.148 * r - 0.291 * g + 0.439 * b + 0.5;
+    double v =  0.439 * r - 0.368 * g - 0.071 * b + 0.5;
+
+    auto quantize = []( double value )
+    {
+      return (uint32_t)std::clamp( (int)std::lround( value * 255.0 ), 0, 255 );
+    };
+
+    result[color] = quantize( y ) | ( quantize( u ) << 8 ) | ( quantize( v ) << 16 );
+  }
+
+  return result;
+}
+
+VideoEncoder::PooledFrame VideoEncoder::acquireFrame()
+{
+  std::unique_lock<std::mutex> l{ mFrameMutex };
+
+  rethrowError();
+
+  if ( mFreeFrames.empty() )
+  {
+    if ( mOverflow == Overflow::DROP )
+      return PooledFrame{ nullptr, FrameRelease{ this } };
+
+    mFramesBlocked += 1;
+    mFrameCV.wait( l, [this]
+    {
+      return !mFreeFrames.empty() || mError;
+    } );
+    rethrowError();
+  }
+
+  AVFrame* frame = mFreeFrames.back();
+  mFreeFrames.pop_back();
+  return PooledFrame{ frame, FrameRelease{ this } };
+}
+
+void VideoEncoder::releaseFrame( AVFrame* frame )
+{
+  {
+    std::scoped_lock<std::mutex> l{ mFrameMutex };
+    mFreeFrames.push_back( frame );
+  }
+  mFrameCV.notify_all();
+}
+
+void VideoEncoder::FrameRelease::operator()( AVFrame* frame ) const
+{
+  encoder->releaseFrame( frame );
+}
 
-    if ( mAudioQueue.size() < mAudioStream->frame->nb_samples * 2 )
-      return true;
+//the encoding thread has ended on error, so the error is kept for every later call to fail
+void VideoEncoder::rethrowError()
+{
+  if ( mError )
+    std::rethrow_exception( mError );
+}
 
-    for ( int j = 0; j < mAudioStream->frame->nb_samples; j++ )
+void VideoEncoder::encodingLoop()
+{
+  try
+  {
+    for ( ;; )
     {
-      ( (float*)mAudioStream->frame->data[0] )[j] = mAudioQueue.front();
-      mAudioQueue.pop();
-      ( (float*)mAudioStream->frame->data[1] )[j] = mAudioQueue.front();
-      mAudioQueue.pop();
+      PendingFrame pending;
+      {
+        std::unique_lock<std::mutex> l{ mFrameMutex };
+        mFrameCV.wait( l, [this]
+        {
+          return !mPendingFrames.empty() || mFinish;
+        } );
+
+        if ( mPendingFrames.empty() )
+          return;
+
+        pending = mPendingFrames.front();
+        mPendingFrames.pop_front();
+      }
+
+      if ( pending.frame )
+      {
+        pushFrame( &*mVideoStream->encoder, mVideoStream->st, pending.frame );
+        releaseFrame( pending.frame );
+      }
+      mVideoStream->nextPts = pending.pts + 1;
+
+      encodeAudio( mVideoStream->nextPts );
     }
+  }
+  catch ( ... )
+  {
+    {
+      std::scoped_lock<std::mutex> l{ mFrameMutex };
+      mError = std::current_exception();
+    }
+    mFrameCV.notify_all();
+  }
+}
+
+void VideoEncoder::encodeAudio( int64_t videoPts )
+{
+  while ( av_compare_ts( videoPts, mVideoStream->encoder->time_base, mAudioStream->nextPts, mAudioStream->encoder->time_base ) > 0 )
+  {
+    int ret = av_frame_make_writable( &*mAudioStream->frame );
+    if ( ret < 0 )
+      throw Ex{};
+
+    auto begin = std::chrono::steady_clock::now();
+    if ( !mAudioRing.pop( (float*)mAudioStream->frame->data[0], (float*)mAudioStream->frame->data[1], mAudioStream->frame->nb_samples ) )
+      return;
+    mAudioConvertNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - begin ).count();
 
     mAudioStream->frame->pts = av_rescale_q( mAudioStream->nextPts, AVRational{ 1, mAudioStream->encoder->sample_rate }, mAudioStream->encoder->time_base );
     mAudioStream->nextPts  += mAudioStream->frame->nb_samples;
 
     pushFrame( &*mAudioStream->encoder, mAudioStream->st, &*mAudioStream->frame );
   }
-
-  return true;
 }
 
 IEncoder* createEncoder( char const* path, int vbitrate, int abitrate, int width, int height )
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <filesystem>
+#include <memory>
 #include <span>
 #include <mutex>
-#include <queue>
+#include <thread>
+#include <vector>
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +49,7 @@ extern "C" {
 #define SAMPLE_RATE 48000 /* 25 images/s */
 
 #include "API/IEncoder.hpp"
+#include "AudioRing.hpp"
 
 class VideoEncoder : public IEncoder
 {
@@ -49,6 +58,8 @@ public:
   ~VideoEncoder() override;
 
   void pushAudioBuffer( std::span<float const> buf ) override;
+  void setOverflow( Overflow overflow ) override;
+  Stats stats() const override;
 
   uint32_t width() const override;
   uint32_t height() const override;
@@ -56,11 +67,36 @@ public:
 
   void startEncoding( int fpsNumerator, int fpsDenominator ) override;
   bool writeFrame( uint8_t const* y, int ystride, uint8_t const* u, int ustride, uint8_t const* v, int vstride ) override;
+  bool writeNativeFrame( uint16_t const* colors ) override;
+  bool repeatFrame() override;
 
 private:
+  struct FrameRelease
+  {
+    VideoEncoder* encoder;
+    void operator()( AVFrame* frame ) const;
+  };
+  //pooled frame goes back to the pool unless it is queued
+  using PooledFrame = std::unique_ptr<AVFrame, FrameRelease>;
+
+  struct PendingFrame
+  {
+    //nullptr repeats the previous frame
+    AVFrame* frame;
+    int64_t pts;
+  };
+
   void openVideo( int width, int height, int bitrate, AVRational fps );
   void openAudio( int bitrate );
   int pushFrame( AVCodecContext *c, AVStream *st, AVFrame const* frame );
+  PooledFrame acquireFrame();
+  void releaseFrame( AVFrame* frame );
+  void queueFrame( PooledFrame frame );
+  void enqueue( PendingFrame pending );
+  static std::array<uint32_t, 4096> makeYUVLut();
+  void encodingLoop();
+  void encodeAudio( int64_t videoPts );
+  void rethrowError();
   static std::shared_ptr<AVFrame> allocVideoFrame( enum AVPixelFormat pix_fmt, int width, int height );
   static std::shared_ptr<AVFrame> allocAudioFrame( enum AVSampleFormat sample_fmt, uint64_t channel_layout, int sample_rate, int nb_samples );
 
@@ -87,9 +123,30 @@ private:
   std::shared_ptr<StreamContext> mVideoStream;
   int mWidth;
   int mHeight;
-
-  std::mutex mMutex;
-  std::queue<float> mAudioQueue;
+  //Y | U << 8 | V << 16 for each 12-bit Lynx color
+  std::array<uint32_t, 4096> const mYUVLut;
+
+  AudioRing mAudioRing;
+  std::atomic<uint64_t> mAudioFramesDropped;
+  std::atomic<uint64_t> mAudioConvertNanoseconds;
+
+  //pool of preallocated YUV frames cycling between writeFrame and the encoding thread
+  static constexpr size_t FRAME_POOL_SIZE = 8;
+  std::vector<std::shared_ptr<AVFrame>> mFramePool;
+  std::vector<AVFrame*> mFreeFrames;
+  std::deque<PendingFrame> mPendingFrames;
+  //pts of the next frame written, the stream's nextPts is that of the encoding thread
+  int64_t mNextVideoPts;
+  std::mutex mFrameMutex;
+  std::condition_variable mFrameCV;
+  std::thread mEncodingThread;
+  std::exception_ptr mError;
+  bool mFinish;
+  Overflow mOverflow;
+  std::atomic<uint64_t> mFramesWritten;
+  std::atomic<uint64_t> mFramesDropped;
+  std::atomic<uint64_t> mFramesBlocked;
+  std::atomic<uint64_t> mFramesRepeated;
 };
 
 
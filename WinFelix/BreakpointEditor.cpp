@@ -3,8 +3,9 @@
 #include "Manager.hpp"
 #include "Core.hpp"
 #include "Debugger.hpp"
+#include "SymbolSource.hpp"
 
-BreakpointEditor::BreakpointEditor()
+BreakpointEditor::BreakpointEditor() : mManager{}, mItems{}, mNewItemAddrBuf{}, mNewItemConditionBuf{}, mNewItemBreakpointType{}, mConditionError{}
 {
 }
 
@@ -64,6 +65,8 @@ void BreakpointEditor::initializeExistingTraps()
 
     item.type = std::get<0>( trap );
     item.address = std::get<1>( trap );
+    if ( auto conditional = std::dynamic_pointer_cast<ConditionalBreakpointTrap>( std::get<2>( trap ) ) )
+      item.condition = conditional->condition().source();
 
     mItems.push_back( item );
   }
@@ -87,20 +90,35 @@ void BreakpointEditor::deleteBreakpoint( const BreakpointItem* item )
   mItems.erase( std::remove( mItems.begin(), mItems.end(), *item ), mItems.end() );
 }
 
-void BreakpointEditor::addBreakpoint( ScriptDebugger::Type type, const char* addr )
+void BreakpointEditor::addBreakpoint( ScriptDebugger::Type type, const char* addr, const char* condition )
 {
   int v;
   sscanf( addr, "%04X", &v );
-  addBreakpoint( type, v );
+  addBreakpoint( type, v, condition );
 }
 
-void BreakpointEditor::addBreakpoint( ScriptDebugger::Type type, uint16_t addr )
+void BreakpointEditor::addBreakpoint( ScriptDebugger::Type type, uint16_t addr, std::string_view condition )
 {
   if ( addr > 0xffff )
   {
     return;
   }
 
+  std::shared_ptr<IMemoryAccessTrap> trap;
+  if ( condition.empty() )
+  {
+    trap = std::make_shared<UIBreakpointTrap>();
+  }
+  else if ( auto compiled = BreakpointCondition::compile( condition, mManager->mSymbols ? &mManager->mSymbols->table() : nullptr, mConditionError ) )
+  {
+    trap = std::make_shared<ConditionalBreakpointTrap>( std::move( *compiled ), IMemoryAccessTrap::UI );
+  }
+  else
+  {
+    return;
+  }
+  mConditionError.clear();
+
   BreakpointItem item;
 
   if ( !mItems.empty() )
@@ -109,8 +127,7 @@ void BreakpointEditor::addBreakpoint( ScriptDebugger::Type type, uint16_t addr )
   }
   item.type = type;
   item.address = addr;
-
-  auto trap = std::make_shared<UIBreakpointTrap>();
+  item.condition = condition;
 
   mManager->mInstance->getScriptDebugger()->addTrap( item.type, item.address, trap);
   mItems.push_back( item );
@@ -159,16 +176,28 @@ void BreakpointEditor::drawContents()
       return;
     }
 
-    addBreakpoint( mNewItemBreakpointType, mNewItemAddrBuf );
+    addBreakpoint( mNewItemBreakpointType, mNewItemAddrBuf, mNewItemConditionBuf );
+  }
+
+  ImGui::Text( "Condition" );
+
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth( 250 );
+  ImGui::InputText( "##bpcondition", mNewItemConditionBuf, sizeof( mNewItemConditionBuf ) );
+
+  if ( !mConditionError.empty() )
+  {
+    ImGui::TextColored( ImVec4( 1, 0, 0, 1 ), "%s", mConditionError.c_str() );
   }
 
   ImGui::Separator();
 
-  if ( ImGui::BeginTable( "##bpitems", 3, ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit ) )
+  if ( ImGui::BeginTable( "##bpitems", 4, ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit ) )
   {
     ImGui::TableSetupColumn( "Del" );
     ImGui::TableSetupColumn( "Address" );
     ImGui::TableSetupColumn( "Type" );
+    ImGui::TableSetupColumn( "Condition" );
     ImGui::TableSetupScrollFreeze( 0, 1 );
     ImGui::TableHeadersRow();
 
@@ -188,6 +217,9 @@ void BreakpointEditor::drawContents()
 
       ImGui::TableNextColumn();
       ImGui::Text( breakpointTypeGetDesc( item.type ) );
+
+      ImGui::TableNextColumn();
+      ImGui::Text( "%s", item.condition.c_str() );
     }
     ImGui::EndTable();
   }
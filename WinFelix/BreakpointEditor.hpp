@@ -2,6 +2,7 @@
 
 #include "Editors.hpp"
 #include "ScriptDebugger.hpp"
+#include "BreakpointCondition.hpp"
 #include "Core.hpp"
 #include "CPU.hpp"
 
@@ -29,6 +30,8 @@ typedef struct BreakpointItem
   uint32_t id = 0;
   ScriptDebugger::Type type;
   uint16_t address = 0;
+  //empty for unconditional breakpoint
+  std::string condition;
 
   bool operator==( const BreakpointItem& b )
   {
@@ -54,15 +57,17 @@ private:
   std::vector<BreakpointItem> mItems;
 
   char mNewItemAddrBuf[6];
+  char mNewItemConditionBuf[128];
   ScriptDebugger::Type mNewItemBreakpointType;
+  std::string mConditionError;
 
   bool isReadOnly();
 
   void initializeExistingTraps();
   void deleteBreakpoint( uint16_t address );
   void deleteBreakpoint( const BreakpointItem* item );
-  void addBreakpoint( ScriptDebugger::Type type, const char* addr );
-  void addBreakpoint( ScriptDebugger::Type type, uint16_t addr );
+  void addBreakpoint( ScriptDebugger::Type type, const char* addr, const char* condition );
+  void addBreakpoint( ScriptDebugger::Type type, uint16_t addr, std::string_view condition = {} );
   const char* breakpointTypeGetDesc( ScriptDebugger::Type type ) const;
 };
 
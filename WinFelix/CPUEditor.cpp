@@ -180,7 +180,9 @@ void CPUEditor::drawContents()
     return;
   }
 
-  auto& state = mManager->mInstance->debugState();
+  //registers are editable only while emulation is stopped
+  CPUState view = mManager->mDebugView->cpu;
+  auto& state = isReadOnly() ? view : mManager->mInstance->debugState();
 
   drawRegister( "A", state.a );
   drawRegister( "X", state.x );
@@ -257,7 +257,7 @@ void DX11Renderer::internalRender( UI& ui )
   if ( !resizeOutput() )
     return;
 
-  updateSourceFromNextFrame();
+  bool sourceChanged = updateSourceFromNextFrame();
 
   UINT v[4] = { 255, 255, 255, 255 };
   gImmediateContext->ClearUnorderedAccessViewUint( mBackBufferUAV.Get(), v );
@@ -269,7 +269,7 @@ void DX11Renderer::internalRender( UI& ui )
 
   if ( mEncodingRenderer )
   {
-    mEncodingRenderer->renderEncoding( mSourceSRV.Get() );
+    mEncodingRenderer->renderEncoding( mSourceSRV.Get(), sourceChanged );
   }
 
   renderGui( ui );
@@ -298,9 +298,11 @@ bool DX11Renderer::resizeOutput()
   return (bool)mScreenGeometry;
 }
 
-void DX11Renderer::updateSourceFromNextFrame()
+bool DX11Renderer::updateSourceFromNextFrame()
 {
-  if ( auto frame = mVideoSink->pullNextFrame() )
+  auto frame = mVideoSink->pullNextFrame();
+  //palette changes of a duplicate frame leave the palette as it was after the previous one
+  if ( frame && !frame->duplicate() )
   {
     D3D11_MAPPED_SUBRESOURCE d3dmap;
     gImmediateContext->Map( mSource.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &d3dmap );
@@ -332,7 +334,10 @@ void DX11Renderer::updateSourceFromNextFrame()
     }
 
     gImmediateContext->Unmap( mSource.Get(), 0 );
+    return true;
   }
+
+  return false;
 }
 
 void DX11Renderer::renderGui( UI& ui )
@@ -41,7 +41,7 @@ private:
 
   void internalRender( UI& ui );
   bool resizeOutput();
-  void updateSourceFromNextFrame();
+  bool updateSourceFromNextFrame();
   void renderGui( UI& ui );
   void renderScreenView( ScreenGeometry const& geometry, ID3D11ShaderResourceView* sourceSRV, ID3D11UnorderedAccessView* target );
   bool mainScreenViewDebugRendering( std::shared_ptr<ScreenView> mainScreenView );
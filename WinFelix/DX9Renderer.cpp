@@ -116,7 +116,8 @@ void DX9Renderer::internalRender( UI& ui )
   }
 
   {
-    if ( auto frame = mVideoSink->pullNextFrame() )
+    auto frame = mVideoSink->pullNextFrame();
+    if ( frame && !frame->duplicate() )
     {
       struct MappedTexture
       {
@@ -16,6 +16,8 @@ mDebugMode{},
 visualizeCPU{},
 visualizeMemory{},
 visualizeDisasm{},
+visualizeSearch{},
+visualizePerf{},
 mVisualizeHistory{},
 mDebugModeOnBreak{},
 mNormalModeOnRun{},
@@ -30,6 +32,8 @@ mRunMode{ RunMode::RUN }
   visualizeWatch = sysConfig->visualizeWatch;
   visualizeBreakpoint = sysConfig->visualizeBreakpoint;
   visualizeDisasm = sysConfig->visualizeDisasm;
+  visualizeSearch = sysConfig->visualizeSearch;
+  visualizePerf = sysConfig->visualizePerf;
   mVisualizeHistory = sysConfig->visualizeHistory;
   mDebugModeOnBreak = sysConfig->debugModeOnBreak;
   mNormalModeOnRun = sysConfig->normalModeOnRun;
@@ -50,6 +54,8 @@ Debugger::~Debugger()
   sysConfig->visualizeWatch = visualizeWatch;
   sysConfig->visualizeBreakpoint = visualizeBreakpoint;
   sysConfig->visualizeDisasm = visualizeDisasm;
+  sysConfig->visualizeSearch = visualizeSearch;
+  sysConfig->visualizePerf = visualizePerf;
   sysConfig->visualizeHistory = mVisualizeHistory;
   sysConfig->debugModeOnBreak = mDebugModeOnBreak;
   sysConfig->normalModeOnRun = mNormalModeOnRun;
@@ -187,3 +193,8 @@ std::unique_lock<std::mutex> Debugger::lockMutex() const
 {
   return std::unique_lock<std::mutex>{ mMutex };
 }
+
+std::unique_lock<std::mutex> Debugger::tryLockMutex() const
+{
+  return std::unique_lock<std::mutex>{ mMutex, std::try_to_lock };
+}
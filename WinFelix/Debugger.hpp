@@ -53,12 +53,16 @@ public:
   DebugWindow& historyVisualizer();
 
   std::unique_lock<std::mutex> lockMutex() const;
+  //lock does not own the mutex if it is held by another thread
+  std::unique_lock<std::mutex> tryLockMutex() const;
 
   bool visualizeCPU;
   bool visualizeMemory;
   bool visualizeWatch;
   bool visualizeBreakpoint;
   bool visualizeDisasm;
+  bool visualizeSearch;
+  bool visualizePerf;
 
 private:
   mutable std::mutex mMutex;
@@ -8,8 +8,11 @@
 #include "ConfigProvider.hpp"
 #include "SysConfig.hpp"
 #include "BreakpointEditor.hpp"
+#include "DisassemblyCache.hpp"
+#include "SymbolSource.hpp"
+#include "SymbolTable.hpp"
 
-DisasmEditor::DisasmEditor() : mPC{ 0 }, mFollowPC { 0 }
+DisasmEditor::DisasmEditor() : mDisassembly{}, mDisassemblyInstance{}, mPC{ 0 }, mFollowPC { 0 }
 {
   auto sysConfig = gConfigProvider.sysConfig();
 
@@ -60,25 +63,51 @@ void DisasmEditor::drawContents()
   drawOptions();
 }
 
+DisassemblyCache & DisasmEditor::updateDisassembly()
+{
+  auto const& view = *mManager->mDebugView;
+
+  if ( !mDisassembly || mDisassemblyInstance.lock() != mManager->mInstance )
+  {
+    mDisassembly = std::make_unique<DisassemblyCache>( mManager->mInstance->debugCPU() );
+    mDisassemblyInstance = mManager->mInstance;
+    if ( mManager->mSymbols )
+    {
+      auto const& symbols = mManager->mSymbols->table();
+      for ( uint32_t address = 0; address < 0x10000; ++address )
+      {
+        if ( !symbols.labels( (uint16_t)address ).empty() )
+          mDisassembly->seed( (uint16_t)address );
+      }
+    }
+  }
+
+  mDisassembly->update( view.ram );
+  mDisassembly->seed( view.opcodes );
+  mDisassembly->seed( view.cpu.pc );
+
+  return *mDisassembly;
+}
+
 void DisasmEditor::drawTable()
 {
   char buf[100];
   auto& cpu = mManager->mInstance->debugCPU();
-  auto ram = mManager->mInstance->debugRAM();
+  auto ram = mManager->mDebugView->ram.data();
+  auto& disassembly = updateDisassembly();
   auto opColor = IM_COL32( 126, 88, 137, 255 );
   auto tableSize = ImGui::GetWindowSize();
   tableSize.y -= ImGuiStyleVar_CellPadding * 3;
   int itemCount = (int)(tableSize.y / (float)ImGuiStyleVar_CellPadding) + 1;
-  uint8_t oprLength = 0;
-  int prevPC;
 
-  mPC = cpu.state().pc;
+  mPC = mManager->mDebugView->cpu.pc;
   if ( mFollowPC )
   {
     mTablePC = mPC;
   }
 
-  int workingPc = mTablePC;
+  mTablePC = disassembly.rowStart( (uint16_t)mTablePC );
+  uint16_t workingPc = (uint16_t)mTablePC;
 
   ImGui::BeginTable( "##DisasmTable", 3, ImGuiTableFlags_ScrollY | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp, tableSize );
 
@@ -132,35 +161,44 @@ void DisasmEditor::drawTable()
       mManager->mDebugWindows.breakpointEditor.toggleBreapoint( workingPc );
     }
 
-    memset( buf, 0, 50 );
-    prevPC = workingPc;
-    cpu.disasmOp( buf, (Opcode)ram[workingPc] );
-    oprLength = cpu.disasmOpr( ram, (char*)buf+20, workingPc );
-
     ImGui::TableNextColumn();
-    const uint8_t* ram = mManager->mInstance->debugRAM();
-    sprintf( buf+10, "%02X", ram[prevPC++]);
-    for (uint8_t i = 0; i < oprLength; ++i )
+    uint8_t size = disassembly.rowSize( workingPc );
+    sprintf( buf, "%02X", ram[workingPc] );
+    for ( uint8_t i = 1; i < size; ++i )
     {
-      sprintf( buf + 12 + i * 3, " %02X", ram[prevPC++] );
+      sprintf( buf + 2 + ( i - 1 ) * 3, " %02X", ram[workingPc + i] );
     }
 
-    ImGui::Text( buf + 10 );
+    ImGui::Text( buf );
 
     ImGui::TableNextColumn();
+    std::string_view text = disassembly.text( workingPc );
+    //operand values are shown only where they are about to be used
+    bool live = workingPc == mPC && !disassembly.isData( workingPc );
+    if ( live )
+    {
+      int pc = workingPc;
+      memset( buf, 0, sizeof( buf ) );
+      cpu.disasmOpr( ram, buf, pc );
+      text = text.substr( 0, 5 );
+    }
+
     ImGui::PushStyleColor( ImGuiCol_Text, opColor );
-    ImGui::Text( buf );
+    ImGui::TextUnformatted( text.data(), text.data() + std::min<size_t>( text.size(), 4 ) );
     ImGui::PopStyleColor();
 
     ImGui::SameLine();
-    ImGui::Text( buf + 20 );
+    if ( live )
+      ImGui::TextUnformatted( buf );
+    else
+      ImGui::TextUnformatted( text.data() + std::min<size_t>( text.size(), 5 ), text.data() + text.size() );
 
-    if ( workingPc < 0xffff && !itemCount && ImGui::IsItemVisible() )
+    if ( !itemCount && ImGui::IsItemVisible() )
     {
       scrollDown();
     }
 
-  } while ( --itemCount >= 0 );
+  } while ( --itemCount >= 0 && disassembly.nextRow( workingPc ) );
 
   ImGui::SetScrollY( ImGuiStyleVar_CellPadding );
 
@@ -190,57 +228,23 @@ void DisasmEditor::drawOptions()
   if ( ImGui::InputText( "##disasmtableaddr", addrbuf.data(), addrbuf.size(), ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_CharsUppercase | ImGuiInputTextFlags_EnterReturnsTrue ) )
   {
     std::from_chars( addrbuf.data(), addrbuf.data() + addrbuf.size(), mTablePC, 16 );
+    //entered address is taken for an instruction start
+    if ( mDisassembly )
+      mDisassembly->seed( (uint16_t)mTablePC );
   }
   ImGui::EndDisabled();
 }
 
 void DisasmEditor::scrollUp()
 {
-  char buf[50]{};
-  int prevPC;
-
-  auto& cpu = mManager->mInstance->debugCPU();
-  auto ram = mManager->mInstance->debugRAM();
-
-  for ( char i = 1; i < 4; ++i )
-  {
-    prevPC = mTablePC - i;
-    if ( !cpu.disasmOp( buf, (Opcode)ram[prevPC] ) )
-    {
-      continue;
-    }
-    cpu.disasmOpr( ram, (char*)buf + 5, prevPC );
-
-    if ( mTablePC == prevPC )
-    {
-      mTablePC -= i;
-      return;
-    }
-  }
-
-  for ( char i = 1; i < 4; ++i )
-  {
-    prevPC = mTablePC - i;
-    if ( !cpu.disasmOp( buf, (Opcode)ram[prevPC] ) )
-    {
-      continue;
-    }
-    if (i == cpu.disasmOpr( ram, (char*)buf + 5, prevPC ))
-    {
-      mTablePC -= i;
-      return;
-    }
-  }
-
-  --mTablePC;
+  uint16_t address = (uint16_t)mTablePC;
+  if ( mDisassembly && mDisassembly->previousRow( address ) )
+    mTablePC = address;
 }
 
 void DisasmEditor::scrollDown()
 {
-  char buf[50];
-  auto& cpu = mManager->mInstance->debugCPU();
-  auto ram = mManager->mInstance->debugRAM();
-  
-  cpu.disasmOp( buf, (Opcode)ram[mTablePC] );
-  cpu.disasmOpr( ram, (char*)buf, mTablePC );
-}
\ No newline at end of file
+  uint16_t address = (uint16_t)mTablePC;
+  if ( mDisassembly && mDisassembly->nextRow( address ) )
+    mTablePC = address;
+}
@@ -10,6 +10,8 @@
 #define LABEL_WIDTH 16
 
 class Manager;
+class Core;
+class DisassemblyCache;
 
 class DisasmEditor
 {
@@ -24,6 +26,9 @@ public:
 private:
 
   Manager* mManager;
+  //layout of instance it was made for
+  std::unique_ptr<DisassemblyCache> mDisassembly;
+  std::weak_ptr<Core> mDisassemblyInstance;
   int mPC;
   int mTablePC;
   bool mFollowPC;
@@ -31,6 +36,7 @@ private:
 
   bool isReadOnly();
 
+  DisassemblyCache & updateDisassembly();
   void drawTable();
   void drawOptions();
   void scrollUp();
@@ -4,11 +4,12 @@
 #include "rendererYUV.hxx"
 #include "Utility.hpp"
 #include "DX11Helpers.hpp"
+#include "Log.hpp"
 
 #define V_THROW(x) { HRESULT hr_ = (x); if( FAILED( hr_ ) ) { throw std::runtime_error{ "DXError" }; } }
 
 EncodingRenderer::EncodingRenderer( std::shared_ptr<IEncoder> encoder, ComPtr<ID3D11Device> pD3DDevice, ComPtr<ID3D11DeviceContext> pImmediateContext, rational::Ratio<int32_t> refreshRate ) :
-  mEncoder{ std::move( encoder ) }, mD3DDevice{ std::move( pD3DDevice ) }, mImmediateContext{ std::move( pImmediateContext ) }, mCb{}, mRefreshRate{ refreshRate }
+  mEncoder{ std::move( encoder ) }, mD3DDevice{ std::move( pD3DDevice ) }, mImmediateContext{ std::move( pImmediateContext ) }, mCb{}, mRefreshRate{ refreshRate }, mStagingIndex{}, mStagingPending{}
 {
   mCb.vscale = mEncoder->width() / SCREEN_WIDTH;
 
@@ -25,7 +26,10 @@ EncodingRenderer::EncodingRenderer( std::shared_ptr<IEncoder> encoder, ComPtr<ID
 
   {
     D3D11_TEXTURE2D_DESC descsrc{ width, height, 1, 1, DXGI_FORMAT_R8_UNORM, { 1, 0 }, D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_READ };
-    V_THROW( mD3DDevice->CreateTexture2D( &descsrc, nullptr, mStagingY.ReleaseAndGetAddressOf() ) );
+    for ( auto & staging : mStagingY )
+    {
+      V_THROW( mD3DDevice->CreateTexture2D( &descsrc, nullptr, staging.ReleaseAndGetAddressOf() ) );
+    }
   }
 
   {
@@ -36,7 +40,10 @@ EncodingRenderer::EncodingRenderer( std::shared_ptr<IEncoder> encoder, ComPtr<ID
 
   {
     D3D11_TEXTURE2D_DESC descsrc{ width / 2, height / 2, 1, 1, DXGI_FORMAT_R8_UNORM, { 1, 0 }, D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_READ };
-    V_THROW( mD3DDevice->CreateTexture2D( &descsrc, nullptr, mStagingU.ReleaseAndGetAddressOf() ) );
+    for ( auto & staging : mStagingU )
+    {
+      V_THROW( mD3DDevice->CreateTexture2D( &descsrc, nullptr, staging.ReleaseAndGetAddressOf() ) );
+    }
   }
 
   {
@@ -47,7 +54,10 @@ EncodingRenderer::EncodingRenderer( std::shared_ptr<IEncoder> encoder, ComPtr<ID
 
   {
     D3D11_TEXTURE2D_DESC descsrc{ width / 2, height / 2, 1, 1, DXGI_FORMAT_R8_UNORM, { 1, 0 }, D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_READ };
-    V_THROW( mD3DDevice->CreateTexture2D( &descsrc, nullptr, mStagingV.ReleaseAndGetAddressOf() ) );
+    for ( auto & staging : mStagingV )
+    {
+      V_THROW( mD3DDevice->CreateTexture2D( &descsrc, nullptr, staging.ReleaseAndGetAddressOf() ) );
+    }
   }
 
   V_THROW( mD3DDevice->CreateComputeShader( g_RendererYUV, sizeof g_RendererYUV, nullptr, mRendererYUVCS.ReleaseAndGetAddressOf() ) );
@@ -56,8 +66,18 @@ EncodingRenderer::EncodingRenderer( std::shared_ptr<IEncoder> encoder, ComPtr<ID
   V_THROW( mD3DDevice->CreateBuffer( &bd, NULL, mVSizeCB.ReleaseAndGetAddressOf() ) );
 }
 
-void EncodingRenderer::renderEncoding( ID3D11ShaderResourceView* srv )
+void EncodingRenderer::renderEncoding( ID3D11ShaderResourceView* srv, bool sourceChanged )
 {
+  if ( !sourceChanged && mStagingPending )
+  {
+    //the pending frame is written first so that the repeat follows it
+    writeStaged( ( mStagingIndex + STAGING_COUNT - 1 ) % STAGING_COUNT );
+    mStagingPending = false;
+  }
+
+  if ( !sourceChanged && mEncoder->repeatFrame() )
+    return;
+
   {
     UAVGuard ug{ mImmediateContext, { mPreStagingYUAV.Get(), mPreStagingUUAV.Get(), mPreStagingVUAV.Get() } };
     SRVGuard sg{ mImmediateContext, srv };
@@ -69,14 +89,41 @@ void EncodingRenderer::renderEncoding( ID3D11ShaderResourceView* srv )
     mImmediateContext->Dispatch( SCREEN_WIDTH / 32, SCREEN_HEIGHT / 2, 1 );
   }
 
-  mImmediateContext->CopyResource( mStagingY.Get(), mPreStagingY.Get() );
-  mImmediateContext->CopyResource( mStagingU.Get(), mPreStagingU.Get() );
-  mImmediateContext->CopyResource( mStagingV.Get(), mPreStagingV.Get() );
+  mImmediateContext->CopyResource( mStagingY[mStagingIndex].Get(), mPreStagingY.Get() );
+  mImmediateContext->CopyResource( mStagingU[mStagingIndex].Get(), mPreStagingU.Get() );
+  mImmediateContext->CopyResource( mStagingV[mStagingIndex].Get(), mPreStagingV.Get() );
+
+  size_t previous = ( mStagingIndex + STAGING_COUNT - 1 ) % STAGING_COUNT;
+  if ( mStagingPending )
+  {
+    writeStaged( previous );
+  }
+
+  mStagingPending = true;
+  mStagingIndex = ( mStagingIndex + 1 ) % STAGING_COUNT;
+}
 
+EncodingRenderer::~EncodingRenderer()
+{
+  try
+  {
+    if ( mStagingPending )
+    {
+      writeStaged( ( mStagingIndex + STAGING_COUNT - 1 ) % STAGING_COUNT );
+    }
+  }
+  catch ( std::exception const& ex )
+  {
+    L_ERROR << "Encoder: " << ex.what();
+  }
+}
+
+void EncodingRenderer::writeStaged( size_t index )
+{
   D3D11_MAPPED_SUBRESOURCE resY, resU, resV;
-  mImmediateContext->Map( mStagingY.Get(), 0, D3D11_MAP_READ, 0, &resY );
-  mImmediateContext->Map( mStagingU.Get(), 0, D3D11_MAP_READ, 0, &resU );
-  mImmediateContext->Map( mStagingV.Get(), 0, D3D11_MAP_READ, 0, &resV );
+  mImmediateContext->Map( mStagingY[index].Get(), 0, D3D11_MAP_READ, 0, &resY );
+  mImmediateContext->Map( mStagingU[index].Get(), 0, D3D11_MAP_READ, 0, &resU );
+  mImmediateContext->Map( mStagingV[index].Get(), 0, D3D11_MAP_READ, 0, &resV );
 
   if ( !mEncoder->writeFrame( (uint8_t const*)resY.pData, resY.RowPitch, (uint8_t const*)resU.pData, resU.RowPitch, (uint8_t const*)resV.pData, resV.RowPitch ) )
   {
@@ -84,7 +131,7 @@ void EncodingRenderer::renderEncoding( ID3D11ShaderResourceView* srv )
     mEncoder->writeFrame( (uint8_t const*)resY.pData, resY.RowPitch, (uint8_t const*)resU.pData, resU.RowPitch, (uint8_t const*)resV.pData, resV.RowPitch );
   }
 
-  mImmediateContext->Unmap( mStagingY.Get(), 0 );
-  mImmediateContext->Unmap( mStagingU.Get(), 0 );
-  mImmediateContext->Unmap( mStagingV.Get(), 0 );
+  mImmediateContext->Unmap( mStagingY[index].Get(), 0 );
+  mImmediateContext->Unmap( mStagingU[index].Get(), 0 );
+  mImmediateContext->Unmap( mStagingV[index].Get(), 0 );
 }
@@ -8,10 +8,16 @@ class EncodingRenderer
 {
 public:
   EncodingRenderer( std::shared_ptr<IEncoder> encoder, ComPtr<ID3D11Device> pD3DDevice, ComPtr<ID3D11DeviceContext> pImmediateContext, rational::Ratio<int32_t> refreshRate );
+  ~EncodingRenderer();
 
-  void renderEncoding( ID3D11ShaderResourceView* srv );
+  //unchanged source is not converted, encoder repeats previous frame instead
+  void renderEncoding( ID3D11ShaderResourceView* srv, bool sourceChanged );
 
 private:
+  void writeStaged( size_t index );
+
+  //staging textures are double buffered so that the frame copied in this render is mapped in the next one
+  static constexpr size_t STAGING_COUNT = 2;
 
   std::shared_ptr<IEncoder> mEncoder;
   ComPtr<ID3D11Device>              mD3DDevice;
@@ -19,9 +25,9 @@ private:
   ComPtr<ID3D11Texture2D>           mPreStagingY;
   ComPtr<ID3D11Texture2D>           mPreStagingU;
   ComPtr<ID3D11Texture2D>           mPreStagingV;
-  ComPtr<ID3D11Texture2D>           mStagingY;
-  ComPtr<ID3D11Texture2D>           mStagingU;
-  ComPtr<ID3D11Texture2D>           mStagingV;
+  std::array<ComPtr<ID3D11Texture2D>, STAGING_COUNT> mStagingY;
+  std::array<ComPtr<ID3D11Texture2D>, STAGING_COUNT> mStagingU;
+  std::array<ComPtr<ID3D11Texture2D>, STAGING_COUNT> mStagingV;
   ComPtr<ID3D11UnorderedAccessView> mPreStagingYUAV;
   ComPtr<ID3D11UnorderedAccessView> mPreStagingUUAV;
   ComPtr<ID3D11UnorderedAccessView> mPreStagingVUAV;
@@ -35,6 +41,8 @@ private:
     uint32_t padding3;
   } mCb;
   rational::Ratio<int32_t> mRefreshRate;
+  size_t mStagingIndex;
+  bool mStagingPending;
 
 
 };
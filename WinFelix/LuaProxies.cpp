@@ -4,8 +4,10 @@
 #include "Manager.hpp"
 #include "Core.hpp"
 #include "CPUState.hpp"
+#include "BreakpointCondition.hpp"
+#include "Log.hpp"
 
-void TrapProxy::set( TrapProxy& proxy, int idx, sol::function fun )
+void TrapProxy::set( TrapProxy& proxy, int idx, sol::object value )
 {
   struct LuaTrap : public IMemoryAccessTrap
   {
@@ -25,9 +27,20 @@ void TrapProxy::set( TrapProxy& proxy, int idx, sol::function fun )
     }
   };
 
-  if ( idx >= 0 && idx < 65536 )
+  if ( idx < 0 || idx >= 65536 )
+    return;
+
+  if ( auto condition = value.as<sol::optional<std::string>>() )
+  {
+    std::string error;
+    if ( auto compiled = BreakpointCondition::compile( *condition, nullptr, error ) )
+      proxy.scriptDebuggerEscapes->addTrap( proxy.type, (uint16_t)idx, std::make_shared<ConditionalBreakpointTrap>( std::move( *compiled ), IMemoryAccessTrap::LUA ) );
+    else
+      L_WARNING << "Breakpoint condition \"" << *condition << "\": " << error;
+  }
+  else if ( auto fun = value.as<sol::optional<sol::function>>() )
   {
-    proxy.scriptDebuggerEscapes->addTrap( proxy.type, (uint16_t)idx, std::make_shared<LuaTrap>( fun ) );
+    proxy.scriptDebuggerEscapes->addTrap( proxy.type, (uint16_t)idx, std::make_shared<LuaTrap>( *fun ) );
   }
 }
 
@@ -203,6 +216,53 @@ sol::object CPUProxy::get( sol::stack_object key, sol::this_state L )
   return sol::object( L, sol::in_place, sol::lua_nil );
 }
 
+void RamSnapshot::capture()
+{
+  if ( manager.mInstance )
+    std::memcpy( data.data(), manager.mInstance->debugRAM(), data.size() );
+}
+
+int RamSnapshot::byte( int address ) const
+{
+  return data[address & 0xffff];
+}
+
+std::string RamSnapshot::read( int address, int size ) const
+{
+  address = std::clamp( address, 0, 0x10000 );
+  size = std::clamp( size, 0, 0x10000 - address );
+  return std::string{ (char const*)data.data() + address, (size_t)size };
+}
+
+sol::table RamSnapshot::changes( sol::this_state L ) const
+{
+  sol::state_view lua{ L };
+  sol::table result = lua.create_table();
+  if ( !manager.mInstance )
+    return result;
+
+  auto ram = manager.mInstance->debugRAM();
+  int index = 1;
+  for ( size_t i = 0; i < data.size(); )
+  {
+    //skip equal blocks at once
+    static constexpr size_t BLOCK = 64;
+    if ( i + BLOCK <= data.size() && std::memcmp( data.data() + i, ram + i, BLOCK ) == 0 )
+    {
+      i += BLOCK;
+      continue;
+    }
+    size_t end = std::min( i + BLOCK, data.size() );
+    for ( ; i < end; ++i )
+    {
+      if ( data[i] != ram[i] )
+        result[index++] = i;
+    }
+  }
+
+  return result;
+}
+
 void CPUProxy::set( sol::stack_object key, sol::stack_object value, sol::this_state )
 {
   if ( auto optSt = key.as<sol::optional<std::string>>() )
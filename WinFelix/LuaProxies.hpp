@@ -9,7 +9,8 @@ struct TrapProxy
   std::shared_ptr<ScriptDebuggerEscapes> scriptDebuggerEscapes;
   ScriptDebugger::Type type;
 
-  static void set( TrapProxy & proxy, int idx, sol::function fun );
+  //function called with trapped value and address or condition string breaking emulation when it holds
+  static void set( TrapProxy & proxy, int idx, sol::object value );
 };
 
 struct RamProxy
@@ -52,3 +53,16 @@ struct CPUProxy
   void set( sol::stack_object key, sol::stack_object value, sol::this_state );
 };
 
+//Copy of whole RAM reused by each capture
+struct RamSnapshot
+{
+  Manager& manager;
+  std::vector<uint8_t> data;
+
+  void capture();
+  int byte( int address ) const;
+  std::string read( int address, int size ) const;
+  //ascending addresses at which RAM differs from the snapshot
+  sol::table changes( sol::this_state L ) const;
+};
+
@@ -25,11 +25,31 @@
 #include "ISystemDriver.hpp"
 #include "VGMWriter.hpp"
 #include "TraceHelper.hpp"
+#include "VideoSink.hpp"
+#include "Rewind.hpp"
+#include "InputMovie.hpp"
+#include "Profiler.hpp"
+#include "Coverage.hpp"
 
 
 Manager::Manager() : mUI{ *this },
 mLua{},
+mOnFrame{},
 mDoReset{ false },
+mStateRequest{ StateRequest::NONE },
+mSavedState{},
+mSavedStateInstance{},
+mRewind{ std::make_unique<Rewind>( (size_t)gConfigProvider.sysConfig()->rewind.budgetMB << 20 ) },
+mRewindInstance{},
+mRewindEnabled{ gConfigProvider.sysConfig()->rewind.enabled },
+mRewinding{},
+mRewindFrame{},
+mRewindStepTime{},
+mRunAheadFrames{ gConfigProvider.sysConfig()->runAheadFrames },
+mRunAheadState{},
+mRunAheadFrame{},
+mRunAheadNanoseconds{},
+mRunAheadMuted{},
 mDebugger{},
 mProcessThreads{},
 mJoinThreads{},
@@ -38,8 +58,20 @@ mAudioThread{},
 mRenderingTime{},
 mScriptDebuggerEscapes{ std::make_shared<ScriptDebuggerEscapes>() },
 mImageProperties{},
+mInputPerScanline{},
+mInputRecorder{},
+mInputPlayer{},
+mSavedStateMovieFrame{},
+mSavedStateMovieTick{},
+mProfilePath{},
+mProfiler{},
+mCoveragePath{},
+mCoverageFrames{},
+mCoverage{},
 mRenderer{},
-mDebugWindows{}
+mDebugWindows{},
+mDebugViews{ std::make_unique<TripleBuffer<DebugView>>() },
+mDebugView{}
 {
   mDebugger( RunMode::RUN );
   mAudioOut = std::make_shared<WinAudioOut>();
@@ -75,13 +107,31 @@ mDebugWindows{}
             std::scoped_lock<std::mutex> l{ mMutex };
             renderingTime = mRenderingTime;
           }
+          processStateRequest();
           if ( mAudioOut->wait() )
           {
             auto runMode = mDebugger.mRunMode.load();
-            auto cpuBreakType = mAudioOut->fillBuffer( mInstance, renderingTime, runMode );
-            if ( cpuBreakType != CpuBreakType::NEXT )
+            if ( runMode == RunMode::RUN && mRewinding.load() && rewindStep() )
             {
-              mDebugger.mRunMode.store( RunMode::PAUSE );
+              mAudioOut->fillBuffer( mInstance, renderingTime, RunMode::PAUSE );
+            }
+            else
+            {
+              bool runAheadOn = runAheadActive( runMode );
+              //only speculative frames are presented during run-ahead
+              if ( mInstance && runAheadOn != mRunAheadMuted )
+              {
+                mInstance->muteVideo( runAheadOn );
+                mRunAheadMuted = runAheadOn;
+              }
+              auto cpuBreakType = mAudioOut->fillBuffer( mInstance, renderingTime, runMode );
+              if ( cpuBreakType != CpuBreakType::NEXT )
+              {
+                mDebugger.mRunMode.store( RunMode::PAUSE );
+              }
+              captureRewind();
+              if ( runAheadOn )
+                runAhead();
             }
           }
           mSystemDriver->setPaused( mDebugger.mRunMode.load() != RunMode::RUN );
@@ -124,6 +174,7 @@ void Manager::initialize( std::shared_ptr<ISystemDriver> systemDriver )
   mDebugWindows.watchEditor.setManager( this );
   mDebugWindows.disasmEditor.setManager( this );
   mDebugWindows.breakpointEditor.setManager( this );
+  mDebugWindows.searchEditor.setManager( this );
 
   mSystemDriver = std::move( systemDriver );
   mRenderer = mSystemDriver->baseRenderer();
@@ -147,6 +198,181 @@ IUserInput& Manager::userInput() const
 Manager::~Manager()
 {
   stopThreads();
+  writeProfile();
+  writeCoverage();
+
+  if ( mEncoder )
+  {
+    auto stats = mEncoder->stats();
+    L_NOTICE << "Encoder: " << stats.framesWritten << " frames written, " << stats.framesRepeated << " repeated, " << stats.framesDropped << " dropped, " << stats.framesBlocked << " blocked";
+    L_NOTICE << "Encoder: " << stats.audioFramesDropped << " audio frames dropped, " << stats.audioConvertMicroseconds << " us spent converting audio";
+  }
+
+  if ( auto videoSink = std::dynamic_pointer_cast<VideoSink>( mRenderer->getVideoSink() ) )
+  {
+    uint64_t frames = videoSink->mFrameCount;
+    uint64_t duplicates = videoSink->mDuplicateFrameCount;
+    L_NOTICE << "Video: " << duplicates << " of " << frames << " frames were duplicates (" << ( frames ? 100 * duplicates / frames : 0 ) << "% skipped)";
+  }
+
+  auto rewindStats = mRewind->stats();
+  L_NOTICE << "Rewind: " << rewindStats.states << " states in " << rewindStats.usedBytes << " bytes, capture " << rewindStats.captureNanoseconds / 1000 << " us, step back " << rewindStats.stepBackNanoseconds / 1000 << " us";
+
+  gConfigProvider.sysConfig()->rewind.enabled = mRewindEnabled.load();
+  gConfigProvider.sysConfig()->runAheadFrames = mRunAheadFrames.load();
+}
+
+void Manager::processStateRequest()
+{
+  //about one frame, enough for Suzy to finish a sprite list
+  static constexpr uint64_t BOUNDARY_TICKS = 16000000 / 60;
+
+  auto request = mStateRequest.exchange( StateRequest::NONE );
+  if ( request == StateRequest::NONE || !mInstance )
+    return;
+
+  auto begin = std::chrono::steady_clock::now();
+
+  if ( request == StateRequest::SAVE )
+  {
+    mInstance->runToSnapshotBoundary( BOUNDARY_TICKS );
+    if ( !mInstance->snapshot( mSavedState ) )
+    {
+      L_WARNING << "State not saved: machine did not reach serializable boundary";
+      return;
+    }
+    mSavedStateInstance = mInstance;
+    if ( mInputPlayer )
+    {
+      mSavedStateMovieFrame = mInputPlayer->frame();
+      mSavedStateMovieTick = mInputPlayer->frameTick();
+    }
+  }
+  else
+  {
+    //recorded input can't be taken back
+    if ( mInputRecorder )
+    {
+      L_WARNING << "State not restored while recording input";
+      return;
+    }
+    if ( mSavedStateInstance.lock() != mInstance || !mInstance->restore( mSavedState ) )
+    {
+      L_WARNING << "State not restored";
+      return;
+    }
+    if ( mInputPlayer )
+      mInputPlayer->seek( mSavedStateMovieFrame, mSavedStateMovieTick );
+    //history leading to the restored state is unknown
+    mRewind->clear();
+  }
+
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - begin ).count();
+  L_NOTICE << ( request == StateRequest::SAVE ? "State saved: " : "State restored: " ) << mSavedState.size() << " bytes in " << us << " us";
+}
+
+bool Manager::rewindStep()
+{
+  static constexpr uint64_t FRAME_TICKS = 16000000 / 60;
+  static constexpr auto FRAME_TIME = std::chrono::microseconds{ 1000000 / 60 };
+
+  if ( !mInstance || !mRewindEnabled.load() || inputMovieActive() || mRewindInstance.lock() != mInstance )
+    return false;
+
+  auto now = std::chrono::steady_clock::now();
+  if ( now < mRewindStepTime )
+    return true;
+  mRewindStepTime = now + FRAME_TIME;
+
+  //at the start of history emulation stays paused while rewind is held
+  if ( mRewind->stepBack( *mInstance ) )
+  {
+    mInstance->muteVideo( false );
+    //next run-ahead frame mutes again
+    mRunAheadMuted = false;
+    //renders the restored frame
+    mInstance->runUntil( mInstance->tick() + FRAME_TICKS );
+  }
+
+  return true;
+}
+
+void Manager::captureRewind()
+{
+  if ( !mInstance || !mRewindEnabled.load() || inputMovieActive() )
+  {
+    mRewind->clear();
+    return;
+  }
+
+  if ( mRewindInstance.lock() != mInstance )
+  {
+    mRewind->clear();
+    mRewindInstance = mInstance;
+  }
+
+  auto frame = mInstance->frameCount();
+  if ( frame != mRewindFrame && mRewind->capture( *mInstance ) )
+  {
+    mRewindFrame = frame;
+  }
+}
+
+bool Manager::runAheadActive( RunMode runMode ) const
+{
+  //trace log and script traps would see speculative frames
+  return mInstance && mRunAheadFrames.load() > 0 && runMode == RunMode::RUN && !mDebugger.isDebugMode() && !inputMovieActive() &&
+    mLogPath.empty() && mScriptDebuggerEscapes->empty();
+}
+
+bool Manager::inputMovieActive() const
+{
+  //speculative emulation would be seen by the movie
+  return mInputRecorder || mInputPlayer;
+}
+
+void Manager::runAhead()
+{
+  //once per emulated frame
+  auto frame = mInstance->frameCount();
+  if ( frame == mRunAheadFrame )
+    return;
+
+  auto begin = std::chrono::steady_clock::now();
+
+  //retried after next buffer if the machine is not at snapshot boundary
+  if ( !mInstance->runAhead( mRunAheadFrames.load(), mRunAheadState ) )
+    return;
+
+  mRunAheadFrame = frame;
+  auto ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - begin ).count();
+  auto old = mRunAheadNanoseconds.load( std::memory_order_relaxed );
+  mRunAheadNanoseconds.store( old ? ( old * 15 + ns ) / 16 : ns, std::memory_order_relaxed );
+}
+
+void Manager::writeProfile()
+{
+  if ( !mProfiler )
+    return;
+
+  if ( mProfiler->write( mProfilePath, mSymbols.get() ) )
+    L_NOTICE << "Profile written to " << mProfilePath.string();
+  else
+    L_WARNING << "Can't write profile to " << mProfilePath.string();
+  mProfiler.reset();
+}
+
+void Manager::writeCoverage()
+{
+  if ( !mCoverage )
+    return;
+
+  auto heatmapPath = std::filesystem::path{ mCoveragePath }.concat( ".png" );
+  if ( mCoverage->write( mCoveragePath ) && mCoverage->writeHeatmap( heatmapPath ) )
+    L_NOTICE << "Coverage written to " << mCoveragePath.string() << " and " << heatmapPath.string();
+  else
+    L_WARNING << "Can't write coverage to " << mCoveragePath.string();
+  mCoverage.reset();
 }
 
 void Manager::quit()
@@ -166,7 +392,13 @@ void Manager::updateDebugWindows()
     return;
   }
 
-  std::unique_lock<std::mutex> l = mDebugger.lockMutex();
+  mInstance->debugCapture( mDebugViews->back() );
+  mDebugViews->publish();
+
+  //emulation does not wait for UI, windows are updated after the next batch
+  std::unique_lock<std::mutex> l = mDebugger.tryLockMutex();
+  if ( !l.owns_lock() )
+    return;
 
   if ( !mDebugWindows.mainScreenView )
   {
@@ -227,10 +459,22 @@ void Manager::processLua( std::filesystem::path const& path )
   luaPath.replace_extension( path.extension().string() + ".lua" );
   cfgPath.replace_extension( path.extension().string() + ".cfg" );
 
+  mSeed = std::nullopt;
+  mLogFilter = {};
+  mProfilePath.clear();
+  mCoveragePath.clear();
+  mCoverageFrames = false;
+  mInputPerScanline = false;
+  mRecordInputPath.clear();
+  mPlayInputPath.clear();
+
+  //refers to the state being replaced, an image without script must not keep the previous one
+  mOnFrame = sol::protected_function{};
+  mLua = sol::state{};
+
   if ( !std::filesystem::exists( luaPath ) && !std::filesystem::exists( cfgPath ) )
     return;
 
-  mLua = sol::state{};
   mLua.open_libraries( sol::lib::base, sol::lib::io );
 
   if ( std::filesystem::exists( cfgPath ) )
@@ -255,11 +499,118 @@ void Manager::processLua( std::filesystem::path const& path )
   mLua["suzy"] = std::make_unique<SuzyProxy>( *this );
   mLua["cpu"] = std::make_unique<CPUProxy>( *this );
 
-  mLua["Encoder"] = [this] ( sol::table const& tab )
+  mLua.new_usertype<RamSnapshot>( "RAMSNAPSHOT", "capture", &RamSnapshot::capture, "byte", &RamSnapshot::byte, "read", &RamSnapshot::read, "changes", &RamSnapshot::changes );
+
+  //block access crosses into Lua once per block instead of once per byte
+  auto clampRange = []( int address, int size )
   {
-    if ( !mExtendedRenderer )
-      throw Ex{} << "Encoder not available";
+    address = std::clamp( address, 0, 0x10000 );
+    return std::make_pair( address, std::clamp( size, 0, 0x10000 - address ) );
+  };
+
+  mLua.set_function( "ram_read", [this, clampRange] ( int address, int size )
+    {
+      auto [first, count] = clampRange( address, size );
+      return mInstance ? std::string{ (char const*)mInstance->debugRAM() + first, (size_t)count } : std::string{};
+    } );
 
+  mLua.set_function( "ram_write", [this, clampRange] ( int address, std::string const& bytes )
+    {
+      auto [first, count] = clampRange( address, (int)bytes.size() );
+      for ( int i = 0; mInstance && i < count; ++i )
+      {
+        mInstance->debugWriteRAM( (uint16_t)( first + i ), (uint8_t)bytes[i] );
+      }
+    } );
+
+  //address of the first byte differing from bytes
+  mLua.set_function( "ram_compare", [this, clampRange] ( int address, std::string const& bytes ) -> sol::optional<int>
+    {
+      auto [first, count] = clampRange( address, (int)bytes.size() );
+      if ( !mInstance )
+        return sol::nullopt;
+      auto ram = mInstance->debugRAM() + first;
+      auto [it, _] = std::mismatch( ram, ram + count, (uint8_t const*)bytes.data() );
+      return it != ram + count ? first + (int)( it - ram ) : sol::optional<int>{};
+    } );
+
+  //address of the first occurence of bytes in the range
+  mLua.set_function( "ram_find", [this, clampRange] ( std::string const& bytes, sol::optional<int> firstAddress, sol::optional<int> lastAddress ) -> sol::optional<int>
+    {
+      int begin = std::clamp( firstAddress.value_or( 0 ), 0, 0xffff );
+      int last = std::clamp( lastAddress.value_or( 0xffff ), 0, 0xffff );
+      auto [first, count] = clampRange( begin, last - begin + 1 );
+      if ( !mInstance || bytes.empty() )
+        return sol::nullopt;
+      auto ram = mInstance->debugRAM() + first;
+      auto it = std::search( ram, ram + count, std::boyer_moore_horspool_searcher{ (uint8_t const*)bytes.data(), (uint8_t const*)bytes.data() + bytes.size() } );
+      return it != ram + count ? first + (int)( it - ram ) : sol::optional<int>{};
+    } );
+
+  mLua.set_function( "mikey_read", [this] ( int address, int size )
+    {
+      std::string result;
+      for ( int i = 0; mInstance && i < std::clamp( size, 0, 0x100 ); ++i )
+      {
+        result.push_back( (char)mInstance->debugReadMikey( (uint16_t)( 0xfd00 | ( ( address + i ) & 0xff ) ) ) );
+      }
+      return result;
+    } );
+
+  mLua.set_function( "suzy_read", [this] ( int address, int size )
+    {
+      std::string result;
+      for ( int i = 0; mInstance && i < std::clamp( size, 0, 0x100 ); ++i )
+      {
+        result.push_back( (char)mInstance->debugReadSuzy( (uint16_t)( 0xfc00 | ( ( address + i ) & 0xff ) ) ) );
+      }
+      return result;
+    } );
+
+  mLua.set_function( "mikey_write", [this] ( int address, std::string const& bytes )
+    {
+      for ( size_t i = 0; mInstance && i < std::min<size_t>( bytes.size(), 0x100 ); ++i )
+      {
+        mInstance->debugWriteMikey( (uint16_t)( 0xfd00 | ( ( address + i ) & 0xff ) ), (uint8_t)bytes[i] );
+      }
+    } );
+
+  mLua.set_function( "suzy_write", [this] ( int address, std::string const& bytes )
+    {
+      for ( size_t i = 0; mInstance && i < std::min<size_t>( bytes.size(), 0x100 ); ++i )
+      {
+        mInstance->debugWriteSuzy( (uint16_t)( 0xfc00 | ( ( address + i ) & 0xff ) ), (uint8_t)bytes[i] );
+      }
+    } );
+
+  mLua.set_function( "ram_snapshot", [this] ()
+    {
+      RamSnapshot snapshot{ *this, std::vector<uint8_t>( 0x10000 ) };
+      snapshot.capture();
+      return snapshot;
+    } );
+
+  mLua.set_function( "on_frame", [this] ( sol::protected_function fun )
+    {
+      mOnFrame = std::move( fun );
+    } );
+
+  //table of counter values by name, empty unless built with performance counters
+  mLua.set_function( "perf_counters", [this] ()
+    {
+      auto result = mLua.create_table();
+      if ( ENABLE_PERF_COUNTERS && mInstance )
+      {
+        mInstance->perfCounters().forEach( [&]( std::string_view name, uint64_t value )
+        {
+          result[std::string{ name }] = value;
+        } );
+      }
+      return result;
+    } );
+
+  mLua["Encoder"] = [this] ( sol::table const& tab )
+  {
     std::filesystem::path path;
     int vbitrate{}, abitrate{}, vscale{};
     if ( sol::optional<std::string> opt = tab["path"] )
@@ -281,6 +632,20 @@ void Manager::processLua( std::filesystem::path const& path )
     if ( vscale % 2 == 1 )
       throw Ex{} << "video_scale must be even number";
 
+    //by default rendering waits for the encoder instead of losing frames
+    IEncoder::Overflow overflow = IEncoder::Overflow::BLOCK;
+    if ( sol::optional<bool> opt = tab["drop_frames"] )
+      overflow = *opt ? IEncoder::Overflow::DROP : IEncoder::Overflow::BLOCK;
+
+    //frames are converted on CPU from the native frame unless GPU conversion of the rendered frame is requested
+    bool gpu{};
+    if ( sol::optional<bool> opt = tab["gpu"] )
+      gpu = *opt;
+
+    auto videoSink = std::dynamic_pointer_cast<VideoSink>( mRenderer->getVideoSink() );
+    if ( gpu ? !mExtendedRenderer : !videoSink )
+      throw Ex{} << "Encoder not available";
+
     static PCREATE_ENCODER s_createEncoder = nullptr;
     static PDISPOSE_ENCODER s_disposeEncoder = nullptr;
 
@@ -292,8 +657,12 @@ void Manager::processLua( std::filesystem::path const& path )
     s_disposeEncoder = (PDISPOSE_ENCODER)GetProcAddress( mEncoderMod, "disposeEncoder" );
 
     mEncoder = std::shared_ptr<IEncoder>( s_createEncoder( path.string().c_str(), vbitrate, abitrate, SCREEN_WIDTH * vscale, SCREEN_HEIGHT * vscale ), s_disposeEncoder );
+    mEncoder->setOverflow( overflow );
 
-    mExtendedRenderer->setEncoder( mEncoder );
+    if ( gpu )
+      mExtendedRenderer->setEncoder( mEncoder );
+    else
+      videoSink->setEncoder( mEncoder );
     mAudioOut->setEncoder( mEncoder );
   };
 
@@ -375,10 +744,48 @@ void Manager::processLua( std::filesystem::path const& path )
   {
     mLogPath = *opt;
   }
+  if ( sol::optional<sol::table> opt = mLua["logPC"] )
+  {
+    mLogFilter.firstPC = ( *opt )[1].get_or( mLogFilter.firstPC );
+    mLogFilter.lastPC = ( *opt )[2].get_or( mLogFilter.lastPC );
+  }
+  if ( sol::optional<sol::table> opt = mLua["logTicks"] )
+  {
+    mLogFilter.firstTick = (uint64_t)( *opt )[1].get_or( (int64_t)mLogFilter.firstTick );
+    mLogFilter.lastTick = (uint64_t)( *opt )[2].get_or( std::numeric_limits<int64_t>::max() );
+  }
+  if ( sol::optional<std::string> opt = mLua["profile"] )
+  {
+    mProfilePath = *opt;
+  }
+  if ( sol::optional<std::string> opt = mLua["coverage"] )
+  {
+    mCoveragePath = *opt;
+  }
+  if ( sol::optional<bool> opt = mLua["coverageFrames"] )
+  {
+    mCoverageFrames = *opt;
+  }
   if ( sol::optional<std::string> opt = mLua["lab"] )
   {
     mSymbols = std::make_unique<SymbolSource>( *opt );
   }
+  if ( sol::optional<int64_t> opt = mLua["seed"] )
+  {
+    mSeed = (uint64_t)*opt;
+  }
+  if ( sol::optional<bool> opt = mLua["inputPerScanline"] )
+  {
+    mInputPerScanline = *opt;
+  }
+  if ( sol::optional<std::string> opt = mLua["recordInput"] )
+  {
+    mRecordInputPath = *opt;
+  }
+  if ( sol::optional<std::string> opt = mLua["playInput"] )
+  {
+    mPlayInputPath = *opt;
+  }
 }
 
 std::optional<InputFile> Manager::computeInputFile()
@@ -412,17 +819,82 @@ void Manager::reset()
   std::unique_lock<std::mutex> l = mDebugger.lockMutex();
   mProcessThreads.store( false );
   //TODO wait for threads to stop.
+  writeProfile();
+  writeCoverage();
   mInstance.reset();
+  mInputRecorder.reset();
+  mInputPlayer.reset();
 
   if ( auto input = computeInputFile() )
   {
-    mInstance = std::make_shared<Core>( *mImageProperties, mComLynxWire, mRenderer->getVideoSink(), mSystemDriver->userInput(),
-      *input, getOptionalBootROM(), mScriptDebuggerEscapes );
+    std::random_device rd{};
+    uint64_t seed = mSeed.value_or( ( (uint64_t)rd() << 32 ) | rd() );
+    std::shared_ptr<IInputSource> inputSource = mSystemDriver->userInput();
+
+    if ( !mPlayInputPath.empty() )
+    {
+      mInputPlayer = InputPlayer::load( mPlayInputPath );
+      if ( mInputPlayer )
+      {
+        //movie is played on the machine it was recorded with
+        seed = mInputPlayer->seed();
+        inputSource = mInputPlayer;
+        L_NOTICE << "Playing input " << mPlayInputPath.string() << ": " << mInputPlayer->frames() << " frames";
+      }
+      else
+      {
+        L_WARNING << "Can't load input " << mPlayInputPath.string();
+      }
+    }
+    else if ( !mRecordInputPath.empty() )
+    {
+      mInputRecorder = std::make_shared<InputRecorder>( inputSource, mRecordInputPath, seed );
+      if ( mInputRecorder->good() )
+      {
+        inputSource = mInputRecorder;
+        L_NOTICE << "Recording input to " << mRecordInputPath.string();
+      }
+      else
+      {
+        L_WARNING << "Can't record input to " << mRecordInputPath.string();
+        mInputRecorder.reset();
+      }
+    }
+
+    mInstance = std::make_shared<Core>( *mImageProperties, mComLynxWire, mRenderer->getVideoSink(), inputSource,
+      *input, getOptionalBootROM(), mScriptDebuggerEscapes, seed );
+    mRunAheadMuted = false;
+    //putting this value as seed into image script reproduces the run
+    L_NOTICE << "Power-on seed: " << (int64_t)seed;
 
     updateRotation();
 
+    mInstance->latchInputPerScanline( mInputPerScanline );
+    if ( mOnFrame.valid() )
+    {
+      mInstance->setFrameCallback( [this]( uint64_t frame )
+      {
+        auto result = mOnFrame( frame );
+        if ( !result.valid() )
+        {
+          sol::error error = result;
+          L_WARNING << "on_frame: " << error.what();
+        }
+      } );
+    }
+    if ( mSymbols )
+      mSymbols->applyLabels( *mInstance->getTraceHelper() );
     if ( !mLogPath.empty() )
-      mInstance->setLog( mLogPath );
+      mInstance->setLog( mLogPath, mLogFilter );
+    if ( !mProfilePath.empty() )
+      mProfiler = mInstance->enableProfiler();
+    if ( !mCoveragePath.empty() )
+    {
+      mCoverage = mInstance->enableCoverage();
+      auto framesPath = std::filesystem::path{ mCoveragePath }.concat( ".frames" );
+      if ( mCoverageFrames && !mCoverage->recordFrames( framesPath ) )
+        L_WARNING << "Can't write coverage frames to " << framesPath.string();
+    }
   }
   else
   {
@@ -9,6 +9,10 @@
 #include "WatchEditor.hpp"
 #include "DisasmEditor.h"
 #include "BreakpointEditor.hpp"
+#include "SearchEditor.hpp"
+#include "PerfOverlay.hpp"
+#include "CpuTrace.hpp"
+#include "DebugView.hpp"
 
 class WinAudioOut;
 class ComLynxWire;
@@ -26,6 +30,11 @@ struct ImGuiIO;
 class IBaseRenderer;
 class IExtendedRenderer;
 class ISystemDriver;
+class Rewind;
+class InputRecorder;
+class InputPlayer;
+class Profiler;
+class Coverage;
 
 class Manager
 {
@@ -46,6 +55,14 @@ private:
   void processLua( std::filesystem::path const& path );
   std::optional<InputFile> computeInputFile();
   void stopThreads();
+  void processStateRequest();
+  bool rewindStep();
+  void captureRewind();
+  bool runAheadActive( RunMode runMode ) const;
+  bool inputMovieActive() const;
+  void runAhead();
+  void writeProfile();
+  void writeCoverage();
   void handleFileDrop( std::filesystem::path path );
 
   void updateDebugWindows();
@@ -59,15 +76,46 @@ private:
   friend struct MikeyProxy;
   friend struct SuzyProxy;
   friend struct CPUProxy;
+  friend struct RamSnapshot;
   friend class UI;
   friend class CPUEditor;
   friend class MemEditor;
   friend class WatchEditor;
   friend class DisasmEditor;
   friend class BreakpointEditor;
+  friend class SearchEditor;
 
   bool mDoReset;
 
+  enum class StateRequest
+  {
+    NONE,
+    SAVE,
+    LOAD
+  };
+
+  //handled on emulation thread
+  std::atomic<StateRequest> mStateRequest;
+  std::vector<uint8_t> mSavedState;
+  //state is restored only into the instance it was saved from
+  std::weak_ptr<Core> mSavedStateInstance;
+
+  //history is captured and stepped on emulation thread
+  std::unique_ptr<Rewind> mRewind;
+  std::weak_ptr<Core> mRewindInstance;
+  std::atomic_bool mRewindEnabled;
+  std::atomic_bool mRewinding;
+  uint64_t mRewindFrame;
+  std::chrono::steady_clock::time_point mRewindStepTime;
+
+  //number of frames presented ahead of emulation to hide input latency of games, 0 to disable
+  std::atomic<int> mRunAheadFrames;
+  std::vector<uint8_t> mRunAheadState;
+  uint64_t mRunAheadFrame;
+  std::atomic<uint64_t> mRunAheadNanoseconds;
+  //video of the instance is muted for run-ahead
+  bool mRunAheadMuted;
+
   Debugger mDebugger;
 
   struct DebugWindows
@@ -79,11 +127,19 @@ private:
     WatchEditor watchEditor;
     DisasmEditor disasmEditor;
     BreakpointEditor breakpointEditor;
+    SearchEditor searchEditor;
+    PerfOverlay perfOverlay;
     std::shared_ptr<IBoard> historyBoard;
   } mDebugWindows;
+  //published on emulation thread after each batch in debug mode
+  std::unique_ptr<TripleBuffer<DebugView>> mDebugViews;
+  //view read by debug windows, taken once per UI frame
+  DebugView const* mDebugView;
 
   UI mUI;
   sol::state mLua;
+  //image script function called at the start of each frame
+  sol::protected_function mOnFrame;
   std::atomic_bool mProcessThreads;
   std::atomic_bool mJoinThreads;
   HMODULE mEncoderMod;
@@ -101,6 +157,28 @@ private:
   std::shared_ptr<ImageProperties> mImageProperties;
   std::filesystem::path mArg;
   std::filesystem::path mLogPath;
+  //image script ranges of traced instructions written to log
+  CpuTraceFilter mLogFilter;
+  //power-on seed from image script, random if not given
+  std::optional<uint64_t> mSeed;
+  //image script option for games that poll input several times per frame
+  bool mInputPerScanline;
+  //input movie from image script, playing takes precedence over recording
+  std::filesystem::path mRecordInputPath;
+  std::filesystem::path mPlayInputPath;
+  //movie of current instance. Rewind and run-ahead are suspended while one is active
+  std::shared_ptr<InputRecorder> mInputRecorder;
+  std::shared_ptr<InputPlayer> mInputPlayer;
+  //playback position at saved state
+  uint64_t mSavedStateMovieFrame;
+  uint64_t mSavedStateMovieTick;
+  //profile of current instance from image script, written when the instance goes away
+  std::filesystem::path mProfilePath;
+  std::shared_ptr<Profiler> mProfiler;
+  //coverage of current instance from image script, written when the instance goes away
+  std::filesystem::path mCoveragePath;
+  bool mCoverageFrames;
+  std::shared_ptr<Coverage> mCoverage;
   std::mutex mMutex;
   int64_t mRenderingTime;
 };
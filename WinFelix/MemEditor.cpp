@@ -72,9 +72,9 @@ void MemEditor::drawContents()
     return;
   }
 
-  auto ram = mManager->mInstance->debugRAM();
-
   mMemoryEditor.ReadOnly = isReadOnly();
+  //emulation is stopped while RAM is editable
+  auto ram = mMemoryEditor.ReadOnly ? mManager->mDebugView->ram.data() : mManager->mInstance->debugRAM();
 
   mMemoryEditor.DrawContents( (void*)ram, 0xFFFF );
 }
@@ -0,0 +1,62 @@
+#include "pch.hpp"
+#include "PerfOverlay.hpp"
+#include "DebugView.hpp"
+#include "imgui.h"
+
+PerfOverlay::PerfOverlay() : mBase{}, mDelta{}, mBaseTick{}, mDeltaTicks{}
+{
+}
+
+PerfOverlay::~PerfOverlay()
+{
+}
+
+void PerfOverlay::update( DebugView const& view )
+{
+  //new instance or rewind
+  if ( view.tick < mBaseTick )
+  {
+    mBase = view.perf;
+    mBaseTick = view.tick;
+    mDeltaTicks = 0;
+  }
+  else if ( view.tick - mBaseTick >= PERIOD_TICKS )
+  {
+    mDelta = view.perf - mBase;
+    mDeltaTicks = view.tick - mBaseTick;
+    mBase = view.perf;
+    mBaseTick = view.tick;
+  }
+}
+
+void PerfOverlay::drawContents( DebugView const& view )
+{
+  update( view );
+
+  if ( mDeltaTicks == 0 )
+  {
+    ImGui::TextUnformatted( "Measuring..." );
+    return;
+  }
+
+  double seconds = mDeltaTicks / (double)PERIOD_TICKS;
+  uint64_t hostNanoseconds = 0;
+  for ( auto ns : mDelta.nanoseconds )
+  {
+    hostNanoseconds += ns;
+  }
+
+  ImGui::Text( "Host %.1f ms per emulated second", hostNanoseconds / 1e6 / seconds );
+  mDelta.forEach( [&]( std::string_view name, uint64_t value )
+  {
+    if ( name.starts_with( "ns." ) )
+      ImGui::Text( "%-10.*s %5.1f%%", (int)name.size() - 3, name.data() + 3, hostNanoseconds ? 100.0 * value / hostNanoseconds : 0.0 );
+  } );
+
+  ImGui::Separator();
+  mDelta.forEach( [&]( std::string_view name, uint64_t value )
+  {
+    if ( value != 0 && !name.starts_with( "ns." ) )
+      ImGui::Text( "%-24.*s %12.0f/s", (int)name.size(), name.data(), value / seconds );
+  } );
+}
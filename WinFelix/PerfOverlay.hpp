@@ -0,0 +1,25 @@
+#pragma once
+
+#include "PerfCounters.hpp"
+
+struct DebugView;
+
+//Shows performance counters as rates per emulated second, averaged over a second
+class PerfOverlay
+{
+public:
+  PerfOverlay();
+  ~PerfOverlay();
+
+  void drawContents( DebugView const& view );
+
+private:
+  static constexpr uint64_t PERIOD_TICKS = 16000000;
+
+  void update( DebugView const& view );
+
+  PerfCounters mBase;
+  PerfCounters mDelta;
+  uint64_t mBaseTick;
+  uint64_t mDeltaTicks;
+};
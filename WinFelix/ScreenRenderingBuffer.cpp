@@ -1,7 +1,7 @@
 #include "pch.hpp"
 #include "ScreenRenderingBuffer.hpp"
 
-ScreenRenderingBuffer::ScreenRenderingBuffer() : mCurrentRow{}
+ScreenRenderingBuffer::ScreenRenderingBuffer( uint64_t seed ) : mCurrentRow{}, mHash{ ( FNV_OFFSET ^ seed ) * FNV_PRIME }, mDuplicate{}
 {
   std::ranges::fill( mSizes, 0 );
   newRow( 104 );
@@ -13,6 +13,7 @@ void ScreenRenderingBuffer::newRow( int row )
   mCurrentRow = &mRows[idx];
   mSize = &mSizes[idx];
   *mSize = 0;
+  mix( (uint16_t)( 0x8000 | idx ) );
 }
 
 ScreenRenderingBuffer::Row const& ScreenRenderingBuffer::row( size_t i ) const
@@ -27,12 +28,29 @@ int ScreenRenderingBuffer::size( size_t i ) const
   return mSizes[i];
 }
 
+uint64_t ScreenRenderingBuffer::hash() const
+{
+  return mHash;
+}
+
+bool ScreenRenderingBuffer::duplicate() const
+{
+  return mDuplicate;
+}
+
+void ScreenRenderingBuffer::setDuplicate( bool duplicate )
+{
+  mDuplicate = duplicate;
+}
+
 void ScreenRenderingBuffer::pushScreenBytes( std::span<uint8_t const> data )
 {
   int idx = *mSize;
   for ( uint8_t byte : data )
   {
-    mCurrentRow->at( idx++ ) = 0xff00 | (uint16_t)byte;
+    uint16_t value = 0xff00 | (uint16_t)byte;
+    mCurrentRow->at( idx++ ) = value;
+    mix( value );
   }
   *mSize = idx & ( LINE_BUFFER_SIZE - 1 );
 }
@@ -41,6 +59,7 @@ void ScreenRenderingBuffer::pushColorChage( uint8_t reg, uint8_t value )
 {
   int idx = *mSize;
   mCurrentRow->at(idx++) = ( reg << 8 ) | value;
+  mix( ( reg << 8 ) | value );
 
   *mSize = idx & ( LINE_BUFFER_SIZE - 1 );
 }
@@ -11,7 +11,8 @@ public:
 
   using Row = std::array<uint16_t, LINE_BUFFER_SIZE>;
 
-  ScreenRenderingBuffer();
+  //seed should identify the palette at the start of the frame
+  ScreenRenderingBuffer( uint64_t seed = 0 );
 
   void newRow( int row );
 
@@ -21,10 +22,26 @@ public:
   Row const& row( size_t i ) const;
   int size( size_t i ) const;
 
+  //rolling hash of everything pushed into the frame
+  uint64_t hash() const;
+  //frame is identical to the previous one
+  bool duplicate() const;
+  void setDuplicate( bool duplicate );
+
 private:
+  static constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+  static constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+  void mix( uint16_t value )
+  {
+    mHash = ( mHash ^ value ) * FNV_PRIME;
+  }
+
   std::array<int, ROWS_COUNT> mSizes;
   std::array<Row, ROWS_COUNT> mRows;
   Row* mCurrentRow;
   int* mSize;
+  uint64_t mHash;
+  bool mDuplicate;
 };
 
@@ -0,0 +1,168 @@
+#include "pch.hpp"
+#include "SearchEditor.hpp"
+#include "Manager.hpp"
+#include "Core.hpp"
+#include "Debugger.hpp"
+#include "RamFreeze.hpp"
+
+SearchEditor::SearchEditor() : mManager{}, mSearch{}, mWidth{}, mPredicate{}, mOperand{}
+{
+}
+
+SearchEditor::~SearchEditor()
+{
+}
+
+void SearchEditor::setManager( Manager* manager )
+{
+  mManager = manager;
+}
+
+bool SearchEditor::enabled()
+{
+  return mManager && mManager->mInstance && mManager->mDebugger.visualizeSearch;
+}
+
+bool SearchEditor::operandUsed() const
+{
+  switch ( (MemorySearch::Predicate)mPredicate )
+  {
+  case MemorySearch::Predicate::EQUAL:
+  case MemorySearch::Predicate::NOT_EQUAL:
+  case MemorySearch::Predicate::INCREASED_BY:
+  case MemorySearch::Predicate::DECREASED_BY:
+    return true;
+  default:
+    return false;
+  }
+}
+
+void SearchEditor::drawContents()
+{
+  if ( !enabled() )
+  {
+    return;
+  }
+
+  auto const& view = *mManager->mDebugView;
+
+  ImGui::AlignTextToFramePadding();
+
+  ImGui::SetNextItemWidth( 90 );
+  ImGui::Combo( "##searchwidth", &mWidth, "Byte\0Word\0BCD byte\0BCD word\0" );
+
+  ImGui::SameLine();
+  if ( ImGui::Button( "Start" ) )
+  {
+    mSearch.start( view.ram, (MemorySearch::Width)mWidth );
+  }
+
+  ImGui::BeginDisabled( !mSearch.started() );
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth( 110 );
+  ImGui::Combo( "##searchpredicate", &mPredicate, "Equal to\0Not equal to\0Changed\0Unchanged\0Increased\0Decreased\0Increased by\0Decreased by\0" );
+
+  if ( operandUsed() )
+  {
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth( 80 );
+    ImGui::InputInt( "##searchoperand", &mOperand );
+    mOperand = std::clamp( mOperand, 0, 0xffff );
+  }
+
+  ImGui::SameLine();
+  if ( ImGui::Button( "Refine" ) )
+  {
+    mSearch.refine( view.ram, (MemorySearch::Predicate)mPredicate, (uint32_t)mOperand );
+  }
+  ImGui::EndDisabled();
+
+  ImGui::SameLine();
+  if ( ImGui::Button( "Thaw all" ) )
+  {
+    mManager->mInstance->ramFreeze()->clear();
+  }
+
+  if ( mSearch.started() )
+  {
+    ImGui::Text( "%zu candidates", mSearch.count() );
+    drawCandidates();
+  }
+}
+
+void SearchEditor::drawCandidates()
+{
+  auto const& view = *mManager->mDebugView;
+  auto freeze = mManager->mInstance->ramFreeze();
+  auto width = mSearch.width();
+
+  if ( ImGui::BeginTable( "##searchcandidates", 5, ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit ) )
+  {
+    ImGui::TableSetupColumn( "Address" );
+    ImGui::TableSetupColumn( "Previous" );
+    ImGui::TableSetupColumn( "Current" );
+    ImGui::TableSetupColumn( "Freeze" );
+    ImGui::TableSetupColumn( "" );
+    ImGui::TableSetupScrollFreeze( 0, 1 );
+    ImGui::TableHeadersRow();
+
+    for ( auto address : mSearch.candidates( MAX_SHOWN ) )
+    {
+      ImGui::PushID( address );
+
+      ImGui::TableNextColumn();
+      ImGui::Text( "$%04X", address );
+
+      ImGui::TableNextColumn();
+      ImGui::Text( "%u", mSearch.previous( address ).value_or( 0 ) );
+
+      ImGui::TableNextColumn();
+      if ( auto current = MemorySearch::value( view.ram, address, width ) )
+        ImGui::Text( "%u", *current );
+      else
+        ImGui::TextUnformatted( "-" );
+
+      ImGui::TableNextColumn();
+      bool frozen = freeze->frozen( address ).has_value();
+      if ( ImGui::Checkbox( "##freeze", &frozen ) )
+        toggleFreeze( address, frozen );
+
+      ImGui::TableNextColumn();
+      if ( ImGui::SmallButton( "Watch" ) )
+        watch( address );
+      ImGui::SameLine();
+      if ( ImGui::SmallButton( "Remove" ) )
+        mSearch.remove( address );
+
+      ImGui::PopID();
+    }
+
+    ImGui::EndTable();
+  }
+}
+
+void SearchEditor::watch( uint16_t address )
+{
+  bool word = mSearch.width() == MemorySearch::Width::WORD || mSearch.width() == MemorySearch::Width::BCD_WORD;
+
+  char label[17];
+  snprintf( label, sizeof( label ), "$%04X", address );
+  mManager->mDebugWindows.watchEditor.addWatch( label, word ? "Uint16" : "Uint8", address );
+  mManager->mDebugger.visualizeWatch = true;
+}
+
+void SearchEditor::toggleFreeze( uint16_t address, bool freeze )
+{
+  bool word = mSearch.width() == MemorySearch::Width::WORD || mSearch.width() == MemorySearch::Width::BCD_WORD;
+  auto ramFreeze = mManager->mInstance->ramFreeze();
+  auto const& view = *mManager->mDebugView;
+
+  for ( uint16_t i = 0; i < ( word ? 2 : 1 ); ++i )
+  {
+    //frozen at the value shown
+    if ( freeze )
+      ramFreeze->freeze( (uint16_t)( address + i ), view.ram[address + i] );
+    else
+      ramFreeze->thaw( (uint16_t)( address + i ) );
+  }
+}
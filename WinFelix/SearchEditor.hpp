@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Editors.hpp"
+#include "MemorySearch.hpp"
+
+class Manager;
+
+class SearchEditor
+{
+public:
+  SearchEditor();
+  ~SearchEditor();
+
+  void setManager( Manager* manager );
+  void drawContents();
+  bool enabled();
+
+private:
+  //candidates listed at most
+  static constexpr size_t MAX_SHOWN = 256;
+
+  Manager* mManager;
+  MemorySearch mSearch;
+  int mWidth;
+  int mPredicate;
+  int mOperand;
+
+  bool operandUsed() const;
+  void drawCandidates();
+  void watch( uint16_t address );
+  void toggleFreeze( uint16_t address, bool freeze );
+};
@@ -73,6 +73,8 @@ void SysConfig::serialize( std::filesystem::path path )
   fout << "};\n";
   fout << "visualizeWatch = " << ( visualizeWatch ? "true;\n" : "false;\n" );
   fout << "visualizeBreakpoint = " << ( visualizeBreakpoint ? "true;\n" : "false;\n" );
+  fout << "visualizeSearch = " << ( visualizeSearch ? "true;\n" : "false;\n" );
+  fout << "visualizePerf = " << ( visualizePerf ? "true;\n" : "false;\n" );
   fout << "visualizeHistory = " << ( visualizeHistory ? "true;\n" : "false;\n" );
   fout << "debugModeOnBreak = " << ( debugModeOnBreak ? "true;\n" : "false;\n" );
   fout << "normalModeOnRun = " << ( normalModeOnRun ? "true;\n" : "false;\n" );
@@ -86,6 +88,11 @@ void SysConfig::serialize( std::filesystem::path path )
   fout << "audio = {\n";
   fout << "\tmute = " << ( audio.mute ? "true;\n" : "false;\n" );
   fout << "};\n";
+  fout << "rewind = {\n";
+  fout << "\tenabled = " << ( rewind.enabled ? "true;\n" : "false;\n" );
+  fout << "\tbudgetMB = " << rewind.budgetMB << ";\n";
+  fout << "};\n";
+  fout << "runAheadFrames = " << runAheadFrames << ";\n";
 }
 
 SysConfig::SysConfig()
@@ -129,6 +136,8 @@ SysConfig::SysConfig( sol::state const& lua )
   disasmOptions.tablePC = lua["disasmOptions"]["tablePC"].get_or( disasmOptions.tablePC );
   visualizeWatch= lua["visualizeWatch"].get_or( visualizeWatch);
   visualizeBreakpoint = lua["visualizeBreakpoint"].get_or( visualizeBreakpoint );
+  visualizeSearch = lua["visualizeSearch"].get_or( visualizeSearch );
+  visualizePerf = lua["visualizePerf"].get_or( visualizePerf );
   visualizeHistory = lua["visualizeHistory"].get_or( visualizeHistory );
   debugModeOnBreak = lua["debugModeOnBreak"].get_or( debugModeOnBreak );
   normalModeOnRun = lua["normalModeOnRun"].get_or( normalModeOnRun );
@@ -142,4 +151,7 @@ SysConfig::SysConfig( sol::state const& lua )
     }
   }
   audio.mute = lua["audio"]["mute"].get_or( audio.mute );
+  rewind.enabled = lua["rewind"]["enabled"].get_or( rewind.enabled );
+  rewind.budgetMB = lua["rewind"]["budgetMB"].get_or( rewind.budgetMB );
+  runAheadFrames = lua["runAheadFrames"].get_or( runAheadFrames );
 }
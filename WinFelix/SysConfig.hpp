@@ -53,6 +53,8 @@ struct SysConfig
   } memoryOptions;
   bool visualizeWatch{};
   bool visualizeBreakpoint{};
+  bool visualizeSearch{};
+  bool visualizePerf{};
   bool visualizeHistory{};
   bool debugModeOnBreak{};
   bool normalModeOnRun{};
@@ -69,6 +71,12 @@ struct SysConfig
   {
     bool mute{};
   } audio;
+  struct Rewind
+  {
+    bool enabled = true;
+    int budgetMB = 64;
+  } rewind;
+  int runAheadFrames{};
 
   SysConfig();
   SysConfig( sol::state const& lua );
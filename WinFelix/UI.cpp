@@ -11,6 +11,7 @@
 #include "Core.hpp"
 #include "CPU.hpp"
 #include "SysConfig.hpp"
+#include "Rewind.hpp"
 
 UI::UI( Manager& manager ) :
   mManager{ manager },
@@ -77,13 +78,27 @@ bool UI::mainMenu( ImGuiIO& io )
   bool stepOverIssued = false;
   bool stepOutIssued = false;
   bool resetIssued = false;
+  bool saveStateIssued = false;
+  bool loadStateIssued = false;
   bool debugMode = mManager.mDebugger.isDebugMode();
 
+  if ( ImGui::IsKeyPressed( ImGuiKey_F1 ) )
+  {
+    saveStateIssued = true;
+  }
+
+  if ( ImGui::IsKeyPressed( ImGuiKey_F2 ) )
+  {
+    loadStateIssued = true;
+  }
+
   if ( ImGui::IsKeyPressed( ImGuiKey_F3 ) )
   {
     resetIssued = true;
   }
 
+  mManager.mRewinding.store( ImGui::IsKeyDown( ImGuiKey_Backspace ) );
+
   if ( ImGui::IsKeyPressed( ImGuiKey_F4 ) && mManager.mExtendedRenderer )
   {
     debugMode = !debugMode;
@@ -139,6 +154,38 @@ bool UI::mainMenu( ImGuiIO& io )
       {
         modalWindow = ModalWindow::PROPERTIES;
       }
+      if ( ImGui::MenuItem( "Save State", "F1" ) )
+      {
+        saveStateIssued = true;
+      }
+      if ( ImGui::MenuItem( "Load State", "F2" ) )
+      {
+        loadStateIssued = true;
+      }
+      ImGui::Separator();
+      bool rewind = mManager.mRewindEnabled.load();
+      if ( ImGui::MenuItem( "Rewind", "Hold Backspace", &rewind ) )
+      {
+        mManager.mRewindEnabled.store( rewind );
+      }
+      auto rewindStats = mManager.mRewind->stats();
+      ImGui::TextDisabled( "%.1f s in %.1f of %.0f MB, capture %.0f us", rewindStats.ticks / 16000000.0, rewindStats.usedBytes / 1048576.0,
+        rewindStats.budgetBytes / 1048576.0, rewindStats.captureNanoseconds / 1000.0 );
+      ImGui::Separator();
+      if ( ImGui::BeginMenu( "Run Ahead" ) )
+      {
+        int runAheadFrames = mManager.mRunAheadFrames.load();
+        for ( int i = 0; i <= 3; ++i )
+        {
+          if ( ImGui::MenuItem( i == 0 ? "Off" : i == 1 ? "1 frame" : i == 2 ? "2 frames" : "3 frames", nullptr, runAheadFrames == i ) )
+          {
+            mManager.mRunAheadFrames.store( i );
+            mManager.mRunAheadNanoseconds.store( 0 );
+          }
+        }
+        ImGui::TextDisabled( "%.0f us per frame", mManager.mRunAheadNanoseconds.load() / 1000.0 );
+        ImGui::EndMenu();
+      }
       ImGui::EndMenu();
     }
     ImGui::EndDisabled();
@@ -189,6 +236,7 @@ bool UI::mainMenu( ImGuiIO& io )
           bool breakpointWindow = mManager.mDebugger.visualizeBreakpoint;
           bool memoryWindow = mManager.mDebugger.visualizeMemory;
           bool disasmWindow = mManager.mDebugger.visualizeDisasm;
+          bool searchWindow = mManager.mDebugger.visualizeSearch;
           bool historyWindow = mManager.mDebugger.isHistoryVisualized();
           if ( ImGui::MenuItem( "CPU Window", "Ctrl+C", &cpuWindow ) )
           {
@@ -210,6 +258,14 @@ bool UI::mainMenu( ImGuiIO& io )
           {
             mManager.mDebugger.visualizeBreakpoint = breakpointWindow;
           }
+          if ( ImGui::MenuItem( "Search Window", "Ctrl+F", &searchWindow ) )
+          {
+            mManager.mDebugger.visualizeSearch = searchWindow;
+          }
+          if constexpr ( ENABLE_PERF_COUNTERS )
+          {
+            ImGui::MenuItem( "Performance Overlay", nullptr, &mManager.mDebugger.visualizePerf );
+          }
           if ( ImGui::MenuItem( "History Window", "Ctrl+H", &historyWindow ) )
           {
             if ( historyWindow )
@@ -341,6 +397,10 @@ bool UI::mainMenu( ImGuiIO& io )
     {
       mManager.mDebugger.visualizeBreakpoint = !mManager.mDebugger.visualizeBreakpoint;
     }
+    if ( ImGui::IsKeyPressed( ImGuiKey_F ) )
+    {
+      mManager.mDebugger.visualizeSearch = !mManager.mDebugger.visualizeSearch;
+    }
     if ( ImGui::IsKeyPressed( ImGuiKey_H ) )
     {
       bool historyWindow = !mManager.mDebugger.isHistoryVisualized();
@@ -372,6 +432,14 @@ bool UI::mainMenu( ImGuiIO& io )
     mManager.reset();
     mManager.mDebugger( RunMode::PAUSE );
   }
+  if ( saveStateIssued )
+  {
+    mManager.mStateRequest.store( Manager::StateRequest::SAVE );
+  }
+  else if ( loadStateIssued )
+  {
+    mManager.mStateRequest.store( Manager::StateRequest::LOAD );
+  }
   if ( stepOutIssued )
   {
     mManager.mDebugger( RunMode::STEP_OUT );
@@ -434,6 +502,10 @@ void UI::drawDebugWindows( ImGuiIO& io )
 
   std::unique_lock<std::mutex> l = mManager.mDebugger.lockMutex();
 
+  //all windows of the frame show the same view
+  mManager.mDebugView = &mManager.mDebugViews->front();
+  auto const& view = *mManager.mDebugView;
+
   auto historyRendering = mManager.renderHistoryWindow();
   bool debugMode = mManager.mDebugger.isDebugMode();
 
@@ -476,6 +548,21 @@ void UI::drawDebugWindows( ImGuiIO& io )
       ImGui::End();
     }
 
+    if ( mManager.mDebugger.visualizeSearch )
+    {
+      ImGui::Begin( "Search", &mManager.mDebugger.visualizeSearch, ImGuiWindowFlags_None );
+      mManager.mDebugWindows.searchEditor.drawContents();
+      ImGui::End();
+    }
+
+    if ( ENABLE_PERF_COUNTERS && mManager.mDebugger.visualizePerf )
+    {
+      ImGui::SetNextWindowBgAlpha( 0.6f );
+      ImGui::Begin( "Performance", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav );
+      mManager.mDebugWindows.perfOverlay.drawContents( view );
+      ImGui::End();
+    }
+
     if ( historyRendering.enabled )
     {
       ImGui::Begin( "History", &historyRendering.enabled, ImGuiWindowFlags_AlwaysAutoResize );
@@ -527,33 +614,33 @@ void UI::drawDebugWindows( ImGuiIO& io )
         ImGui::BeginDisabled();
         if ( mManager.mInstance )
         {
-          uint16_t addr = mManager.mInstance->debugDispAdr();
+          uint16_t addr = view.dispAdr;
           std::sprintf( buf, "%04x", addr );
-          data = std::span<uint8_t const>{ mManager.mInstance->debugRAM() + addr, SCREEN_WIDTH * SCREEN_HEIGHT / 2 };
+          data = view.screen( addr );
           if ( !sv.safePalette )
-            palette = mManager.mInstance->debugPalette();
+            palette = view.palette;
         }
         break;
       case ScreenViewType::VIDBAS:
         ImGui::BeginDisabled();
         if ( mManager.mInstance )
         {
-          uint16_t addr = mManager.mInstance->debugVidBas();
+          uint16_t addr = view.vidBas;
           std::sprintf( buf, "%04x", addr );
-          data = std::span<uint8_t const>{ mManager.mInstance->debugRAM() + addr, SCREEN_WIDTH * SCREEN_HEIGHT / 2 };
+          data = view.screen( addr );
           if ( !sv.safePalette )
-            palette = mManager.mInstance->debugPalette();
+            palette = view.palette;
         }
         break;
       case ScreenViewType::COLLBAS:
         ImGui::BeginDisabled();
         if ( mManager.mInstance )
         {
-          uint16_t addr = mManager.mInstance->debugCollBas();
+          uint16_t addr = view.collBas;
           std::sprintf( buf, "%04x", addr );
-          data = std::span<uint8_t const>{ mManager.mInstance->debugRAM() + addr, SCREEN_WIDTH * SCREEN_HEIGHT / 2 };
+          data = view.screen( addr );
           if ( !sv.safePalette )
-            palette = mManager.mInstance->debugPalette();
+            palette = view.palette;
         }
         break;
       default:  //ScreenViewType::CUSTOM:
@@ -562,9 +649,9 @@ void UI::drawDebugWindows( ImGuiIO& io )
         {
           uint16_t addr = sv.customAddress;
           std::sprintf( buf, "%04x", sv.customAddress );
-          data = std::span<uint8_t const>{ mManager.mInstance->debugRAM() + sv.customAddress, SCREEN_WIDTH * SCREEN_HEIGHT / 2 };
+          data = view.screen( sv.customAddress );
           if ( !sv.safePalette )
-            palette = mManager.mInstance->debugPalette();
+            palette = view.palette;
         }
         break;
       }
@@ -4,7 +4,7 @@
 #include "ConfigProvider.hpp"
 #include "SysConfig.hpp"
 
-UserInput::UserInput() : mXInputDLL{}, mXInputGetCapabilities{}, mXInputGetState{}, mRotation{ ImageProperties::Rotation::NORMAL }, mMapping{}, mPressedCodes{}, mLastState{}, mGamepadPacket{}, mHasGamepad{}
+UserInput::UserInput() : mXInputDLL{}, mXInputGetCapabilities{}, mXInputGetState{}, mRotation{ ImageProperties::Rotation::NORMAL }, mMapping{}, mPressedCodes{}, mLastState{}, mGamepadPacket{}, mHasGamepad{}, mPublished{}
 {
   const char* xinput_dll_names[] =
   {
@@ -89,6 +89,8 @@ void UserInput::keyDown( int code )
 
   if ( !pressed( code ) )
     mPressedCodes.push_back( code );
+
+  publish();
 }
 
 void UserInput::keyUp( int code )
@@ -129,8 +131,10 @@ void UserInput::keyUp( int code )
     break;
   default:
     mPressedCodes.erase( std::remove( mPressedCodes.begin(), mPressedCodes.end(), code ), mPressedCodes.end() );
-    return;
+    break;
   }
+
+  publish();
 }
 
 void UserInput::lostFocus()
@@ -138,11 +142,15 @@ void UserInput::lostFocus()
   std::unique_lock<std::mutex> l{ mMutex };
 
   mPressedCodes.clear();
+  publish();
 }
 
 void UserInput::setRotation( ImageProperties::Rotation rotation )
 {
+  std::unique_lock<std::mutex> l{ mMutex };
+
   mRotation = rotation;
+  publish();
 }
 
 void UserInput::updateGamepad()
@@ -156,8 +164,11 @@ void UserInput::updateGamepad()
   if ( mGamepadPacket == xInputState.dwPacketNumber || result != ERROR_SUCCESS )
     return;
 
+  std::unique_lock<std::mutex> l{ mMutex };
+
   mGamepadPacket = xInputState.dwPacketNumber;
   mLastState = xInputState.Gamepad;
+  publish();
 }
 
 void UserInput::recheckGamepad()
@@ -167,13 +178,26 @@ void UserInput::recheckGamepad()
 
   XINPUT_CAPABILITIES caps;
   auto result = mXInputGetCapabilities( 0, XINPUT_FLAG_GAMEPAD, &caps );
+
+  std::unique_lock<std::mutex> l{ mMutex };
+
   mHasGamepad = result == ERROR_SUCCESS;
+  publish();
 }
 
-KeyInput UserInput::getInput( bool leftHand ) const
+KeyInput UserInput::getInput( bool leftHand, uint64_t tick ) const
 {
-  std::unique_lock<std::mutex> l{ mMutex };
+  auto published = mPublished.load( std::memory_order_acquire );
+  return KeyInput{ (uint32_t)( leftHand ? published >> 32 : published ) };
+}
 
+void UserInput::publish()
+{
+  mPublished.store( (uint64_t)compute( false ).raw() | (uint64_t)compute( true ).raw() << 32, std::memory_order_release );
+}
+
+KeyInput UserInput::compute( bool leftHand ) const
+{
   bool outer = pressed( KeyInput::OUTER );
   bool inner = pressed( KeyInput::INNER );
   bool opt1 = pressed( KeyInput::OPTION1 );
@@ -237,7 +261,10 @@ int UserInput::getVirtualCode( KeyInput::Key k )
 
 void UserInput::updateMapping( KeyInput::Key k, int code )
 {
+  std::unique_lock<std::mutex> l{ mMutex };
+
   mMapping[k] = code;
+  publish();
 }
 
 int UserInput::firstKeyPressed() const
@@ -16,7 +16,7 @@ public:
   void lostFocus();
   void setRotation( ImageProperties::Rotation rotation );
 
-  KeyInput getInput( bool leftHand ) const override;
+  KeyInput getInput( bool leftHand, uint64_t tick ) const override;
 
   int getVirtualCode( KeyInput::Key k ) override;
   void updateMapping( KeyInput::Key k, int code ) override;
@@ -29,6 +29,9 @@ private:
 
   bool pressed( int code ) const;
   bool pressed( KeyInput::Key key ) const;
+  KeyInput compute( bool leftHand ) const;
+  //must be called with mMutex locked after any change of input state
+  void publish();
 
 
 private:
@@ -42,6 +45,8 @@ private:
   PFN_XInputGetState          mXInputGetState;
 
   mutable std::mutex mMutex;
+  //input words for right and left hand in low and high half, read by emulation thread without locking
+  std::atomic<uint64_t> mPublished;
   ImageProperties::Rotation mRotation;
   std::array<int, 9> mMapping;
   std::vector<int> mPressedCodes;
@@ -1,6 +1,8 @@
 #include "pch.hpp"
 #include "VideoSink.hpp"
 #include "ScreenRenderingBuffer.hpp"
+#include "IEncoder.hpp"
+#include "Utility.hpp"
 
 void VideoSink::newFrame( uint64_t tick, uint8_t hbackup )
 {
@@ -8,15 +10,36 @@ void VideoSink::newFrame( uint64_t tick, uint8_t hbackup )
   mBeginTick = tick;
   if ( mActiveFrame )
   {
+    uint64_t hash = mActiveFrame->hash();
+    mActiveFrame->setDuplicate( hash == mLastFrameHash );
+    mLastFrameHash = hash;
+    mFrameCount += 1;
+    mDuplicateFrameCount += mActiveFrame->duplicate() ? 1 : 0;
+
+    if ( mEncoder )
+      encodeFrame( *mActiveFrame );
+
     std::scoped_lock<std::mutex> lock( mQueueMutex );
     if ( mFinishedFrames.size() > 1 )
     {
       mFinishedFrames.pop();
+      //the frame the next one duplicates will never be rendered
+      mFinishedFrames.front()->setDuplicate( false );
     }
     mFinishedFrames.push( std::move( mActiveFrame ) );
     mActiveFrame.reset();
   }
-  mActiveFrame = std::make_shared<ScreenRenderingBuffer>();
+  mActiveFrame = std::make_shared<ScreenRenderingBuffer>( colorRegsHash() );
+}
+
+uint64_t VideoSink::colorRegsHash() const
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for ( uint8_t reg : mColorRegs )
+  {
+    hash = ( hash ^ reg ) * 0x100000001b3ull;
+  }
+  return hash;
 }
 
 void VideoSink::newRow( uint64_t tick, int row )
@@ -90,6 +113,8 @@ void VideoSink::emitScreenData( std::span<uint8_t const> data )
 
 void VideoSink::updateColorReg( uint8_t reg, uint8_t value )
 {
+  mColorRegs[reg & 0x1f] = value;
+
   if ( mActiveFrame )
   {
     mActiveFrame->pushColorChage( reg, value );
@@ -97,10 +122,72 @@ void VideoSink::updateColorReg( uint8_t reg, uint8_t value )
   else
   {
     updatePalette( reg, value );
+    updateEncoderPalette( reg, value );
+  }
+}
+
+void VideoSink::setEncoder( std::shared_ptr<IEncoder> encoder )
+{
+  mEncoderFrame.resize( SCREEN_WIDTH * SCREEN_HEIGHT );
+  mEncoder = std::move( encoder );
+}
+
+void VideoSink::updateEncoderPalette( uint8_t reg, uint8_t value )
+{
+  if ( reg < 16 )
+  {
+    mEncoderPalette[reg] = ( mEncoderPalette[reg] & 0x0ff ) | ( ( value & 0x0f ) << 8 );
+  }
+  else
+  {
+    mEncoderPalette[reg & 0x0f] = ( mEncoderPalette[reg & 0x0f] & 0xf00 ) | value;
+  }
+}
+
+void VideoSink::encodeFrame( ScreenRenderingBuffer const& frame )
+{
+  //the same row mapping as renderers use
+  for ( int i = 0; i < (int)ScreenRenderingBuffer::ROWS_COUNT; ++i )
+  {
+    auto const& row = frame.row( i );
+    int size = frame.size( i );
+    uint16_t* dst = mEncoderFrame.data() + std::max( 0, ( i - 3 ) ) * SCREEN_WIDTH;
+    uint16_t* end = dst + SCREEN_WIDTH;
+
+    for ( int j = 0; j < size; ++j )
+    {
+      uint16_t v = row[j];
+      if ( std::bit_cast<int16_t>( v ) < 0 )
+      {
+        if ( dst < end )
+        {
+          *dst++ = mEncoderPalette[( v >> 4 ) & 0x0f];
+          *dst++ = mEncoderPalette[v & 0x0f];
+        }
+      }
+      else
+      {
+        updateEncoderPalette( v >> 8, (uint8_t)v );
+      }
+    }
+  }
+
+  //palette is tracked above even for duplicates, only pixel conversion is skipped
+  if ( frame.duplicate() && mEncoder->repeatFrame() )
+    return;
+
+  if ( !mEncoder->writeNativeFrame( mEncoderFrame.data() ) )
+  {
+    //Lynx refresh rate rounded to whole frames per second
+    uint64_t fps = mFrameTicks != 0 ? ( 16000000 + mFrameTicks / 2 ) / mFrameTicks : 0;
+    if ( fps < 30 || fps > 120 )
+      fps = 60;
+    mEncoder->startEncoding( (int)fps, 1 );
+    mEncoder->writeNativeFrame( mEncoderFrame.data() );
   }
 }
 
-VideoSink::VideoSink() : mActiveFrame{}, mFinishedFrames{}, mQueueMutex{}, mBeginTick{}, mLastTick{}, mFrameTicks{ ~0ull }
+VideoSink::VideoSink() : mActiveFrame{}, mFinishedFrames{}, mQueueMutex{}, mBeginTick{}, mLastTick{}, mFrameTicks{ ~0ull }, mColorRegs{}, mLastFrameHash{}, mFrameCount{}, mDuplicateFrameCount{}, mEncoder{}, mEncoderPalette{}, mEncoderFrame{}
 {
   for ( uint32_t i = 0; i < 256; ++i )
   {
@@ -2,6 +2,7 @@
 #include "IVideoSink.hpp"
 
 class ScreenRenderingBuffer;
+class IEncoder;
 
 struct VideoSink : public IVideoSink
 {
@@ -29,6 +30,21 @@ struct VideoSink : public IVideoSink
   uint64_t mLastTick;
   uint64_t mFrameTicks;
 
+  //raw color registers as seen by the sink, used to seed frame hash
+  std::array<uint8_t, 32> mColorRegs;
+  uint64_t mLastFrameHash;
+  std::atomic<uint64_t> mFrameCount;
+  std::atomic<uint64_t> mDuplicateFrameCount;
+
+  //CPU encoding path independent of the renderer. Keeps its own copy of the palette as 12-bit colors
+  std::shared_ptr<IEncoder> mEncoder;
+  std::array<uint16_t, 16> mEncoderPalette;
+  std::vector<uint16_t> mEncoderFrame;
+
+  void setEncoder( std::shared_ptr<IEncoder> encoder );
+  void updateEncoderPalette( uint8_t reg, uint8_t value );
+  void encodeFrame( ScreenRenderingBuffer const& frame );
+  uint64_t colorRegsHash() const;
   void updatePalette( uint16_t reg, uint8_t value );
   void newFrame( uint64_t tick, uint8_t hbackup ) override;
   void newRow( uint64_t tick, int row ) override;
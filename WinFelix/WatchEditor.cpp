@@ -3,6 +3,7 @@
 #include "Manager.hpp"
 #include "Core.hpp"
 #include "Debugger.hpp"
+#include "SymbolSource.hpp"
 
 WatchEditor::WatchEditor()
 {
@@ -182,21 +183,63 @@ void WatchEditor::drawPreviewData( const ImU8* mem_data, size_t mem_size, ImGuiD
 
 void WatchEditor::deleteWatch( const char* label )
 {
-  mItems.erase( std::remove_if( mItems.begin(), mItems.end(), [label] ( WatchItem x ) { return 0 == strcmp( x.label, label ); } ), mItems.end() );
+  eraseWatches( [label] ( WatchItem const& x ) { return 0 == strcmp( x.label, label ); } );
 }
 
 void WatchEditor::deleteWatch( uint16_t id )
 {
-  mItems.erase( std::remove_if( mItems.begin(), mItems.end(), [id] ( WatchItem x ) { return x.id == id; } ), mItems.end() );
+  eraseWatches( [id] ( WatchItem const& x ) { return x.id == id; } );
 }
 
 void WatchEditor::deleteWatch( const WatchItem* item )
 {
-  mItems.erase( std::remove( mItems.begin(), mItems.end(), *item ), mItems.end() );
+  eraseWatches( [id = item->id] ( WatchItem const& x ) { return x.id == id; } );
+}
+
+void WatchEditor::updateMonitor()
+{
+  if ( !mManager->mInstance )
+    return;
+
+  auto monitor = mManager->mInstance->writeMonitor();
+  if ( monitor == mMonitor )
+    return;
+
+  //watches move to the monitor of new instance
+  mMonitor = std::move( monitor );
+  for ( auto & item : mItems )
+  {
+    item.monitorId = mMonitor->watch( item.address, (uint16_t)dataTypeGetSize( item.type ) );
+    item.version = 0;
+  }
+}
+
+void WatchEditor::drawHistory( WatchItem const& item ) const
+{
+  auto history = mMonitor->history( item.monitorId );
+  if ( history.empty() )
+    return;
+
+  static constexpr std::array<char const*, 3> SOURCES{ "", " Suzy", " debugger" };
+
+  ImGui::BeginTooltip();
+  for ( auto it = history.crbegin(); it != history.crend(); ++it )
+  {
+    ImGui::Text( "%llu: $%04X <- $%02X by $%04X%s", (unsigned long long)it->tick, it->address, it->value, it->pc, SOURCES[(size_t)it->source] );
+  }
+  ImGui::EndTooltip();
 }
 
 void WatchEditor::addWatch( const char* label, ImGuiDataType type, const char* addr )
 {  
+  //label of a symbol needs no address
+  if ( *addr == 0 )
+  {
+    if ( auto address = mManager->mSymbols ? mManager->mSymbols->symbol( label ) : std::nullopt )
+      addWatch( label, type, *address );
+    return;
+  }
+
   int a;
   sscanf( addr, "%04X", &a );
   addWatch( label, type, a );
@@ -218,6 +261,8 @@ void WatchEditor::addWatch( const char* label, ImGuiDataType type, uint16_t addr
   item.type = type;
   strncpy( item.label, label, 17 );
   item.address = addr;
+  if ( mMonitor )
+    item.monitorId = mMonitor->watch( item.address, (uint16_t)dataTypeGetSize( item.type ) );
 
   mItems.push_back( item );
 }
@@ -236,7 +281,6 @@ void WatchEditor::addWatch( const char* label, const char* type, uint16_t addr )
 
 void WatchEditor::drawContents()
 {
-  ImU8 mDataBuf[8];
   char mDataOutputBuf[8 * 8];
   char mLabelBuf[10];
   WatchItem item{ };
@@ -295,15 +339,17 @@ void WatchEditor::drawContents()
     ImGui::TableSetupScrollFreeze( 0, 1 );
     ImGui::TableHeadersRow();
 
-    for ( const auto& item : mItems ) 
-    {
-      auto size = dataTypeGetSize( item.type );
+    updateMonitor();
 
-      do
+    auto const& view = *mManager->mDebugView;
+    for ( auto& item : mItems ) 
+    {
+      //view holds writes up to its sequence, later ones are read from a later view
+      if ( mMonitor && view.writeMonitor == mMonitor.get() && mMonitor->version( item.monitorId ) > item.version )
       {
-        --size;
-        mDataBuf[size] = mManager->mInstance->debugReadRAM( item.address + (uint16_t)size );
-      } while ( size > 0 );
+        item.version = view.writeSequence;
+        std::copy_n( view.ram.begin() + item.address, dataTypeGetSize( item.type ), item.data );
+      }
 
       sprintf( mLabelBuf, "##wi%d", item.id );
       ImGui::TableNextColumn();
@@ -315,21 +361,23 @@ void WatchEditor::drawContents()
 
       ImGui::TableNextColumn();
       ImGui::Text( item.label );
+      if ( mMonitor && ImGui::IsItemHovered() )
+        drawHistory( item );
 
       ImGui::TableNextColumn();
       snprintf( mDataOutputBuf, 7, "$%04X", item.address );
       ImGui::Text( mDataOutputBuf );
 
       ImGui::TableNextColumn();
-      drawPreviewData( mDataBuf, sizeof( mDataBuf ), item.type, DataFormat_Hex, mDataOutputBuf, sizeof( mDataOutputBuf ) );
+      drawPreviewData( item.data, sizeof( item.data ), item.type, DataFormat_Hex, mDataOutputBuf, sizeof( mDataOutputBuf ) );
       ImGui::Text( mDataOutputBuf );
     
       ImGui::TableNextColumn();
-      drawPreviewData( mDataBuf, sizeof( mDataBuf ), item.type, DataFormat_Dec, mDataOutputBuf, sizeof( mDataOutputBuf ) );
+      drawPreviewData( item.data, sizeof( item.data ), item.type, DataFormat_Dec, mDataOutputBuf, sizeof( mDataOutputBuf ) );
       ImGui::Text( mDataOutputBuf );
 
       ImGui::TableNextColumn();
-      drawPreviewData( mDataBuf, sizeof( mDataBuf ), item.type, DataFormat_Bin, mDataOutputBuf, sizeof( mDataOutputBuf ) );
+      drawPreviewData( item.data, sizeof( item.data ), item.type, DataFormat_Bin, mDataOutputBuf, sizeof( mDataOutputBuf ) );
       ImGui::Text( mDataOutputBuf );
     }
     ImGui::EndTable();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Editors.hpp"
+#include "WriteMonitor.hpp"
 
 class Manager;
 
@@ -10,6 +11,11 @@ typedef struct WatchItem
   char label[17];
   ImGuiDataType type = ImGuiDataType_U8;
   uint16_t address = 0;
+  //watch in write monitor
+  uint32_t monitorId = 0;
+  //write monitor sequence covered by data
+  uint64_t version = 0;
+  ImU8 data[8]{};
 
   bool operator==( const WatchItem& b )
   {
@@ -42,12 +48,27 @@ public:
 private:
   Manager* mManager;
   std::vector<WatchItem> mItems;
+  //write monitor of current instance, data of watches is read only after observed writes
+  std::shared_ptr<WriteMonitor> mMonitor;
 
   char mNewItemLabelBuf[17];
   char mNewItemAddrBuf[6];
   ImGuiDataType mNewItemDataType;
 
   bool isReadOnly();
+  void updateMonitor();
+  void drawHistory( WatchItem const& item ) const;
+
+  template<typename Pred>
+  void eraseWatches( Pred pred )
+  {
+    for ( auto const& item : mItems )
+    {
+      if ( mMonitor && pred( item ) )
+        mMonitor->unwatch( item.monitorId );
+    }
+    std::erase_if( mItems, pred );
+  }
 
   void deleteWatch( const WatchItem* item );
   void deleteWatch( uint16_t id );
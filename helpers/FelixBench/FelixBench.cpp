@@ -0,0 +1,320 @@
+#include "pch.hpp"
+#include "Core.hpp"
+#include "ComLynxWire.hpp"
+#include "ComLynxNetwork.hpp"
+#include "IInputSource.hpp"
+#include "ImageProperties.hpp"
+#include "ImageROM.hpp"
+#include "InputFile.hpp"
+#include "InputMovie.hpp"
+#include "Rewind.hpp"
+#include "PerfCounters.hpp"
+#include "ScriptDebuggerEscapes.hpp"
+#include "AudioRing.hpp"
+
+//Runs an image headless, i.e. without video, audio or input, and reports emulation, snapshot, rewind and run-ahead costs.
+//Recorded input movie replaces the absent input, except for run-ahead that would play it speculatively.
+//Built with performance counters, the first run also dumps them every ten emulated seconds.
+//Finally compares the encoder audio ring with the sample queue it replaced.
+//Link mode instead runs given number of machines on one ComLynx wire through ComLynxNetwork and reports its barrier counts.
+//Usage: FelixBench image [seconds [rewind budget MB [input movie]]]
+//       FelixBench -link players image [seconds]
+
+namespace
+{
+
+static constexpr uint64_t TICKS_PER_SECOND = 16000000;
+static constexpr uint64_t FRAME_TICKS = TICKS_PER_SECOND / 60;
+static constexpr uint64_t PERF_DUMP_FRAMES = 10 * 60;
+
+using Clock = std::chrono::steady_clock;
+
+class NullVideoSink : public IVideoSink
+{
+public:
+  void newFrame( uint64_t tick, uint8_t hbackup ) override {}
+  void newRow( uint64_t tick, int row ) override {}
+  void emitScreenData( std::span<uint8_t const> data ) override {}
+  void updateColorReg( uint8_t reg, uint8_t value ) override {}
+};
+
+class NullInputSource : public IInputSource
+{
+public:
+  KeyInput getInput( bool leftHand, uint64_t tick ) const override
+  {
+    return KeyInput{};
+  }
+};
+
+double microseconds( Clock::duration d )
+{
+  return std::chrono::duration<double, std::micro>( d ).count();
+}
+
+void printPerfCounters( PerfCounters const& counters, double seconds )
+{
+  counters.forEach( [&]( std::string_view name, uint64_t value )
+  {
+    if ( value != 0 )
+      fmt::print( "  {:<24} {:>14} {:>14.0f}/s\n", name, value, value / seconds );
+  } );
+}
+
+//moves about 70 minutes of 48 kHz stereo from the audio to the encoding side in a single thread
+void benchAudioTransfer()
+{
+  static constexpr size_t PUSH_FRAMES = 1000;
+  static constexpr size_t POP_FRAMES = 1024;
+  static constexpr size_t PUSHES = 200000;
+
+  std::vector<float> interleaved( PUSH_FRAMES * 2 );
+  for ( size_t i = 0; i < interleaved.size(); ++i )
+    interleaved[i] = (float)i;
+  std::vector<float> left( POP_FRAMES );
+  std::vector<float> right( POP_FRAMES );
+  double checksum = 0;
+
+  auto ring = std::make_unique<AudioRing>();
+  auto begin = Clock::now();
+  for ( size_t i = 0; i < PUSHES; ++i )
+  {
+    ring->push( interleaved );
+    while ( ring->pop( left.data(), right.data(), POP_FRAMES ) )
+      checksum += left[0] + right[POP_FRAMES - 1];
+  }
+  double ringUs = microseconds( Clock::now() - begin );
+
+  std::mutex mutex;
+  std::queue<float> queue;
+  begin = Clock::now();
+  for ( size_t i = 0; i < PUSHES; ++i )
+  {
+    {
+      std::scoped_lock<std::mutex> lock{ mutex };
+      for ( float sample : interleaved )
+        queue.push( sample );
+    }
+    std::scoped_lock<std::mutex> lock{ mutex };
+    while ( queue.size() >= POP_FRAMES * 2 )
+    {
+      for ( size_t j = 0; j < POP_FRAMES; ++j )
+      {
+        left[j] = queue.front();
+        queue.pop();
+        right[j] = queue.front();
+        queue.pop();
+      }
+      checksum -= left[0] + right[POP_FRAMES - 1];
+    }
+  }
+  double queueUs = microseconds( Clock::now() - begin );
+
+  //checksum keeps both loops from being optimized away and is zero when they moved the same samples
+  fmt::print( "Encoder audio: {} frames, ring {:.3f} s, queue {:.3f} s, checksum {}\n", PUSHES * PUSH_FRAMES, ringUs / 1e6, queueUs / 1e6, checksum );
+}
+
+std::shared_ptr<Core> createCore( std::filesystem::path const& path, std::shared_ptr<ImageProperties> & imageProperties, std::filesystem::path const& moviePath = {},
+  std::shared_ptr<ComLynxWire> wire = std::make_shared<ComLynxWire>() )
+{
+  //fixed power-on state so that runs are comparable
+  static constexpr uint64_t SEED = 0;
+
+  InputFile file{ path, imageProperties };
+  if ( !file.valid() )
+    return {};
+
+  uint64_t seed = SEED;
+  std::shared_ptr<IInputSource> inputSource = std::make_shared<NullInputSource>();
+  if ( !moviePath.empty() )
+  {
+    auto player = InputPlayer::load( moviePath );
+    if ( !player )
+      return {};
+    seed = player->seed();
+    inputSource = player;
+  }
+
+  return std::make_shared<Core>( *imageProperties, std::move( wire ), std::make_shared<NullVideoSink>(), inputSource,
+    file, std::shared_ptr<ImageROM const>{}, std::make_shared<ScriptDebuggerEscapes>(), seed );
+}
+
+//emulated second by second so that a broken machine stops the run early
+int benchLink( int players, std::filesystem::path const& path, uint64_t duration )
+{
+  auto wire = std::make_shared<ComLynxWire>();
+  //cores refer to their image properties
+  std::vector<std::shared_ptr<ImageProperties>> imageProperties( players );
+  std::vector<std::shared_ptr<Core>> cores;
+  for ( auto & properties : imageProperties )
+  {
+    auto core = createCore( path, properties, {}, wire );
+    if ( !core )
+    {
+      fmt::print( "Can't open {}\n", path.string() );
+      return 1;
+    }
+    cores.push_back( std::move( core ) );
+  }
+
+  ComLynxNetwork network{ cores, wire };
+  uint64_t seconds = 0;
+  auto begin = Clock::now();
+  try
+  {
+    for ( ; seconds < duration; ++seconds )
+    {
+      if ( network.run( TICKS_PER_SECOND ) != CpuBreakType::NONE )
+      {
+        fmt::print( "Link: machine {} broke in second {}\n", *network.brokenCore(), seconds );
+        break;
+      }
+    }
+  }
+  catch ( std::exception const& ex )
+  {
+    fmt::print( "Link: machine {} failed in second {}: {}\n", network.brokenCore().value_or( 0 ), seconds, ex.what() );
+    return 1;
+  }
+  double linkUs = microseconds( Clock::now() - begin );
+
+  auto stats = network.stats();
+  double emulated = (double)stats.ticks / TICKS_PER_SECOND;
+  fmt::print( "Link: {} players, {:.1f} s emulated in {:.3f} s, {:.1f}x real time\n", players, emulated, linkUs / 1e6, emulated * 1e6 / linkUs );
+  fmt::print( "Link barriers: {}, {} while the wire was busy, {:.0f} per emulated second\n", stats.barriers, stats.busyBarriers,
+    emulated > 0 ? stats.barriers / emulated : 0.0 );
+  //no transitions means that the machines did not talk to each other
+  fmt::print( "Link wire: {} transitions\n", wire->transitions() );
+  return 0;
+}
+
+}
+
+int main( int argc, char const* argv[] )
+{
+  if ( argc > 3 && std::string_view{ argv[1] } == "-link" )
+  {
+    int players = std::max( 1, std::atoi( argv[2] ) );
+    uint64_t duration = argc > 4 ? std::max( 1, std::atoi( argv[4] ) ) : 60;
+    return benchLink( players, argv[3], duration );
+  }
+
+  if ( argc < 2 )
+  {
+    fmt::print( "Usage: FelixBench image [seconds [rewind budget MB [input movie]]]\n" );
+    fmt::print( "       FelixBench -link players image [seconds]\n" );
+    return 1;
+  }
+
+  std::filesystem::path path{ argv[1] };
+  uint64_t duration = argc > 2 ? std::max( 1, std::atoi( argv[2] ) ) : 60;
+  size_t budgetMB = argc > 3 ? std::max( 1, std::atoi( argv[3] ) ) : 64;
+  std::filesystem::path moviePath = argc > 4 ? argv[4] : "";
+  uint64_t frames = duration * 60;
+
+  std::shared_ptr<ImageProperties> imageProperties;
+  auto core = createCore( path, imageProperties, moviePath );
+  if ( !core )
+  {
+    fmt::print( "Can't open {} {}\n", path.string(), moviePath.string() );
+    return 1;
+  }
+
+  PerfCounters perfDumped{};
+  uint64_t perfDumpedFrame = 0;
+  auto begin = Clock::now();
+  for ( uint64_t i = 0; i < frames; ++i )
+  {
+    core->runUntil( core->tick() + FRAME_TICKS );
+    if ( ENABLE_PERF_COUNTERS && ( ( i + 1 ) % PERF_DUMP_FRAMES == 0 || i + 1 == frames ) )
+    {
+      auto counters = core->perfCounters();
+      fmt::print( "Counters of frames {} to {}:\n", perfDumpedFrame, i + 1 );
+      printPerfCounters( counters - perfDumped, ( i + 1 - perfDumpedFrame ) / 60.0 );
+      perfDumped = counters;
+      perfDumpedFrame = i + 1;
+    }
+  }
+  double plainUs = microseconds( Clock::now() - begin );
+  fmt::print( "Emulation: {} frames in {:.3f} s, {:.1f}x real time\n", frames, plainUs / 1e6, duration * 1e6 / plainUs );
+
+  std::vector<uint8_t> state;
+  core->runToSnapshotBoundary( FRAME_TICKS );
+  begin = Clock::now();
+  bool saved = core->snapshot( state );
+  double saveUs = microseconds( Clock::now() - begin );
+  begin = Clock::now();
+  bool restored = saved && core->restore( state );
+  double restoreUs = microseconds( Clock::now() - begin );
+  if ( restored )
+    fmt::print( "Snapshot: {} bytes, save {:.1f} us, restore {:.1f} us\n", state.size(), saveUs, restoreUs );
+  else
+    fmt::print( "Snapshot: failed\n" );
+
+  //the same seed and input must lead to the same state
+  {
+    std::shared_ptr<ImageProperties> otherProperties;
+    auto other = createCore( path, otherProperties, moviePath );
+    for ( uint64_t i = 0; i < frames; ++i )
+      other->runUntil( other->tick() + FRAME_TICKS );
+    other->runToSnapshotBoundary( FRAME_TICKS );
+    std::vector<uint8_t> otherState;
+    bool identical = saved && other->snapshot( otherState ) && otherState == state;
+    fmt::print( "Determinism: second run {}\n", identical ? "ended in identical state" : "DIVERGED" );
+  }
+
+  //same run again with a capture every frame
+  core = createCore( path, imageProperties, moviePath );
+  Rewind rewind{ budgetMB << 20 };
+  uint64_t captured = 0;
+  begin = Clock::now();
+  for ( uint64_t i = 0; i < frames; ++i )
+  {
+    core->runUntil( core->tick() + FRAME_TICKS );
+    captured += rewind.capture( *core ) ? 1 : 0;
+  }
+  double rewindUs = microseconds( Clock::now() - begin );
+
+  auto stats = rewind.stats();
+  double history = (double)stats.ticks / TICKS_PER_SECOND;
+  fmt::print( "Rewind capture: {} of {} frames, {:.1f}x real time, {:.1f} us per frame ({:.1f} us measured by capture)\n", captured, frames,
+    duration * 1e6 / rewindUs, ( rewindUs - plainUs ) / frames, stats.captureNanoseconds / 1000.0 );
+  fmt::print( "Rewind history: {} states, {:.1f} s in {} of {} bytes, {:.0f} bytes per second\n", stats.states, history,
+    stats.usedBytes, stats.budgetBytes, history > 0 ? stats.usedBytes / history : 0.0 );
+
+  uint64_t steps = 0;
+  double worstUs = 0;
+  begin = Clock::now();
+  for ( ;; )
+  {
+    auto stepBegin = Clock::now();
+    if ( !rewind.stepBack( *core ) )
+      break;
+    worstUs = std::max( worstUs, microseconds( Clock::now() - stepBegin ) );
+    steps += 1;
+  }
+  double stepUs = microseconds( Clock::now() - begin );
+  fmt::print( "Rewind step back: {} steps, {:.1f} us average, {:.1f} us worst, frame time is {:.1f} us\n", steps, steps ? stepUs / steps : 0.0,
+    worstUs, 1e6 / 60 );
+
+  //extra host time per emulated frame of presenting 1 to 3 frames ahead
+  for ( int ahead = 1; ahead <= 3; ++ahead )
+  {
+    core = createCore( path, imageProperties );
+    core->muteVideo( true );
+    uint64_t presented = 0;
+    begin = Clock::now();
+    for ( uint64_t i = 0; i < frames; ++i )
+    {
+      core->runUntil( core->tick() + FRAME_TICKS );
+      presented += core->runAhead( ahead, state ) ? 1 : 0;
+    }
+    double aheadUs = microseconds( Clock::now() - begin );
+    fmt::print( "Run-ahead {}: {} of {} frames presented, {:.1f}x real time, {:.1f} us extra per frame\n", ahead, presented, frames,
+      duration * 1e6 / aheadUs, ( aheadUs - plainUs ) / frames );
+  }
+
+  benchAudioTransfer();
+
+  return 0;
+}
@@ -0,0 +1,348 @@
+#include "pch.hpp"
+#include "Core.hpp"
+#include "ComLynxWire.hpp"
+#include "CPUState.hpp"
+#include "IInputSource.hpp"
+#include "ImageProperties.hpp"
+#include "ImageROM.hpp"
+#include "InputFile.hpp"
+#include "InputMovie.hpp"
+#include "ScriptDebuggerEscapes.hpp"
+
+//Runs a reference core and a differently driven test core on the same image, seed and input side by side and compares
+//their state hashes every frame. On divergence both are replayed to the last matching frame and stepped instruction by
+//instruction to the first differing one, and both states are dumped. Images are checked in parallel on all cores.
+//Test core variants, all of which must not change behaviour:
+//  batch    - runs in slices that do not align with frames
+//  mute     - runs with video muted
+//  restore  - snapshots and restores itself every frame
+//  runahead - runs one frame ahead every frame, not with an input movie that would be played speculatively
+//Usage: FelixLockstep [-s seconds] [-v variant[,variant...]] [-m input movie] image|directory...
+
+namespace
+{
+
+static constexpr uint64_t TICKS_PER_SECOND = 16000000;
+static constexpr uint64_t FRAME_TICKS = TICKS_PER_SECOND / 60;
+//prime, so that slices drift against frames
+static constexpr uint64_t BATCH_TICKS = 7919;
+//fixed power-on state of both cores
+static constexpr uint64_t SEED = 0;
+
+enum class Variant
+{
+  BATCH,
+  MUTE,
+  RESTORE,
+  RUNAHEAD
+};
+
+static constexpr std::array<std::pair<Variant, std::string_view>, 4> VARIANT_NAMES{ {
+  { Variant::BATCH, "batch" },
+  { Variant::MUTE, "mute" },
+  { Variant::RESTORE, "restore" },
+  { Variant::RUNAHEAD, "runahead" }
+} };
+
+struct Result
+{
+  enum
+  {
+    OK,
+    SKIPPED,
+    DIVERGED
+  } outcome;
+  std::string report;
+};
+
+struct Options
+{
+  uint64_t frames = 60 * 60;
+  std::vector<Variant> variants;
+  std::filesystem::path moviePath;
+  std::vector<std::filesystem::path> images;
+};
+
+class NullVideoSink : public IVideoSink
+{
+public:
+  void newFrame( uint64_t tick, uint8_t hbackup ) override {}
+  void newRow( uint64_t tick, int row ) override {}
+  void emitScreenData( std::span<uint8_t const> data ) override {}
+  void updateColorReg( uint8_t reg, uint8_t value ) override {}
+};
+
+class NullInputSource : public IInputSource
+{
+public:
+  KeyInput getInput( bool leftHand, uint64_t tick ) const override
+  {
+    return KeyInput{};
+  }
+};
+
+std::string_view name( Variant variant )
+{
+  return std::ranges::find( VARIANT_NAMES, variant, &std::pair<Variant, std::string_view>::first )->second;
+}
+
+std::shared_ptr<Core> createCore( std::filesystem::path const& path, std::filesystem::path const& moviePath )
+{
+  std::shared_ptr<ImageProperties> imageProperties;
+  InputFile file{ path, imageProperties };
+  if ( !file.valid() )
+    return {};
+
+  uint64_t seed = SEED;
+  std::shared_ptr<IInputSource> inputSource = std::make_shared<NullInputSource>();
+  if ( !moviePath.empty() )
+  {
+    auto player = InputPlayer::load( moviePath );
+    if ( !player )
+      return {};
+    seed = player->seed();
+    inputSource = player;
+  }
+
+  return std::make_shared<Core>( *imageProperties, std::make_shared<ComLynxWire>(), std::make_shared<NullVideoSink>(), inputSource,
+    file, std::shared_ptr<ImageROM const>{}, std::make_shared<ScriptDebuggerEscapes>(), seed );
+}
+
+//runs test core to the first instruction boundary at or after given tick, i.e. where the reference runUntil stops
+void runTest( Core & core, Variant variant, uint64_t tick )
+{
+  if ( variant != Variant::BATCH )
+  {
+    core.runUntil( tick );
+    return;
+  }
+
+  while ( core.tick() < tick )
+  {
+    core.runUntil( std::min( tick, ( core.tick() / BATCH_TICKS + 1 ) * BATCH_TICKS ) );
+  }
+}
+
+void frameAction( Core & core, Variant variant, std::vector<uint8_t> & state )
+{
+  switch ( variant )
+  {
+  case Variant::RESTORE:
+    if ( core.snapshot( state ) )
+      core.restore( state );
+    break;
+  case Variant::RUNAHEAD:
+    core.runAhead( 1, state );
+    break;
+  default:
+    break;
+  }
+}
+
+std::string describe( Core & core )
+{
+  auto & s = core.debugState();
+  return fmt::format( "tick {} PC ${:04x} A ${:02x} X ${:02x} Y ${:02x} S ${:02x} P ${:02x}", core.tick(), s.pc, s.a, s.x, s.y, s.sl, s.getP() );
+}
+
+//both cores are just past the first differing step
+std::string dump( Core & ref, Core & test, std::filesystem::path const& path, Variant variant )
+{
+  auto refHash = ref.stateHash();
+  auto testHash = test.stateHash();
+
+  std::string result = fmt::format( "  reference: {}\n  test:      {}\n  differs in:{}{}{}{}{}\n", describe( ref ), describe( test ),
+    refHash.tick != testHash.tick ? " tick" : "", refHash.cpu != testHash.cpu ? " CPU" : "", refHash.ram != testHash.ram ? " RAM" : "",
+    refHash.mikey != testHash.mikey ? " Mikey" : "", refHash.suzy != testHash.suzy ? " Suzy" : "" );
+
+  int shown = 0;
+  for ( int address = 0; address < 0x10000 && shown < 16; ++address )
+  {
+    if ( ref.debugRAM()[address] != test.debugRAM()[address] )
+    {
+      result += fmt::format( "  RAM ${:04x}: ${:02x} vs ${:02x}\n", address, ref.debugRAM()[address], test.debugRAM()[address] );
+      shown += 1;
+    }
+  }
+
+  std::vector<uint8_t> state;
+  for ( auto [core, suffix] : { std::pair<Core*, char const*>{ &ref, "ref" }, std::pair<Core*, char const*>{ &test, "test" } } )
+  {
+    //whole state if possible, RAM otherwise
+    auto out = std::filesystem::path{ path.stem() }.concat( fmt::format( ".{}.{}", name( variant ), suffix ) );
+    if ( core->snapshot( state ) )
+    {
+      out.concat( ".state" );
+    }
+    else
+    {
+      state.assign( core->debugRAM(), core->debugRAM() + 0x10000 );
+      out.concat( ".ram" );
+    }
+    std::ofstream{ out, std::ios::binary }.write( (char const*)state.data(), state.size() );
+    result += fmt::format( "  dumped {}\n", out.string() );
+  }
+
+  return result;
+}
+
+//replays both cores to given matching frame and steps them to the first differing instruction
+std::string bisect( std::filesystem::path const& path, Options const& options, Variant variant, uint64_t frame )
+{
+  auto ref = createCore( path, options.moviePath );
+  auto test = createCore( path, options.moviePath );
+  test->muteVideo( variant == Variant::MUTE );
+
+  std::vector<uint8_t> state;
+  for ( uint64_t i = 1; i <= frame; ++i )
+  {
+    ref->runUntil( i * FRAME_TICKS );
+    runTest( *test, variant, i * FRAME_TICKS );
+    frameAction( *test, variant, state );
+  }
+
+  uint64_t const end = ( frame + 1 ) * FRAME_TICKS;
+  for ( uint64_t step = 0;; ++step )
+  {
+    uint16_t pc = ref->debugState().pc;
+    ref->runUntil( std::min( end, ref->tick() + 1 ) );
+    runTest( *test, variant, ref->tick() );
+    if ( ref->stateHash() != test->stateHash() )
+      return fmt::format( "first difference after instruction {} of frame {} at PC ${:04x}\n{}", step, frame + 1, pc, dump( *ref, *test, path, variant ) );
+
+    if ( ref->tick() >= end )
+    {
+      frameAction( *test, variant, state );
+      if ( ref->stateHash() != test->stateHash() )
+        return fmt::format( "first difference after end of frame {} action\n{}", frame + 1, dump( *ref, *test, path, variant ) );
+      return fmt::format( "difference not reproduced by stepping frame {}\n", frame + 1 );
+    }
+  }
+}
+
+Result check( std::filesystem::path const& path, Options const& options, Variant variant )
+{
+  auto ref = createCore( path, options.moviePath );
+  auto test = createCore( path, options.moviePath );
+  if ( !ref || !test )
+    return { Result::SKIPPED, "skipped, not an image\n" };
+  test->muteVideo( variant == Variant::MUTE );
+
+  std::vector<uint8_t> state;
+  for ( uint64_t frame = 1; frame <= options.frames; ++frame )
+  {
+    ref->runUntil( frame * FRAME_TICKS );
+    runTest( *test, variant, frame * FRAME_TICKS );
+    frameAction( *test, variant, state );
+
+    if ( ref->stateHash() != test->stateHash() )
+      return { Result::DIVERGED, fmt::format( "diverged in frame {}, ", frame ) + bisect( path, options, variant, frame - 1 ) };
+  }
+
+  return { Result::OK, "ok\n" };
+}
+
+std::optional<Options> parse( int argc, char const* argv[] )
+{
+  Options options;
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string_view arg{ argv[i] };
+    if ( arg == "-s" && i + 1 < argc )
+    {
+      options.frames = std::max( 1, std::atoi( argv[++i] ) ) * 60ull;
+    }
+    else if ( arg == "-m" && i + 1 < argc )
+    {
+      options.moviePath = argv[++i];
+    }
+    else if ( arg == "-v" && i + 1 < argc )
+    {
+      std::string_view list{ argv[++i] };
+      while ( !list.empty() )
+      {
+        auto item = list.substr( 0, list.find( ',' ) );
+        auto it = std::ranges::find( VARIANT_NAMES, item, &std::pair<Variant, std::string_view>::second );
+        if ( it == VARIANT_NAMES.cend() )
+          return {};
+        options.variants.push_back( it->first );
+        list.remove_prefix( std::min( list.size(), item.size() + 1 ) );
+      }
+    }
+    else if ( std::filesystem::is_directory( arg ) )
+    {
+      for ( auto const& entry : std::filesystem::directory_iterator{ arg } )
+      {
+        if ( entry.is_regular_file() )
+          options.images.push_back( entry.path() );
+      }
+    }
+    else
+    {
+      options.images.push_back( arg );
+    }
+  }
+
+  if ( options.variants.empty() )
+  {
+    for ( auto [variant, name] : VARIANT_NAMES )
+      options.variants.push_back( variant );
+  }
+
+  if ( !options.moviePath.empty() )
+    std::erase( options.variants, Variant::RUNAHEAD );
+
+  if ( options.images.empty() )
+    return {};
+
+  return options;
+}
+
+}
+
+int main( int argc, char const* argv[] )
+{
+  auto options = parse( argc, argv );
+  if ( !options )
+  {
+    fmt::print( "Usage: FelixLockstep [-s seconds] [-v variant[,variant...]] [-m input movie] image|directory...\n" );
+    fmt::print( "Variants: batch, mute, restore, runahead\n" );
+    return 1;
+  }
+
+  std::vector<std::pair<std::filesystem::path, Variant>> jobs;
+  for ( auto const& image : options->images )
+  {
+    for ( auto variant : options->variants )
+      jobs.emplace_back( image, variant );
+  }
+
+  std::atomic<size_t> next{};
+  std::atomic<size_t> failed{};
+  std::mutex printMutex;
+
+  std::vector<std::thread> threads;
+  for ( unsigned i = 0; i < std::max( 1u, std::thread::hardware_concurrency() ); ++i )
+  {
+    threads.emplace_back( [&]
+    {
+      for ( size_t job = next++; job < jobs.size(); job = next++ )
+      {
+        auto const& [image, variant] = jobs[job];
+        auto result = check( image, *options, variant );
+
+        std::scoped_lock<std::mutex> l{ printMutex };
+        fmt::print( "{} {}: {}", image.filename().string(), name( variant ), result.report );
+        if ( result.outcome == Result::DIVERGED )
+          failed += 1;
+      }
+    } );
+  }
+
+  for ( auto & thread : threads )
+    thread.join();
+
+  fmt::print( "{} of {} checks failed\n", failed.load(), jobs.size() );
+  return failed.load() ? 2 : 0;
+}
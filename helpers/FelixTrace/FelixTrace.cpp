@@ -0,0 +1,122 @@
+#include "pch.hpp"
+#include "CPU.hpp"
+#include "CPUState.hpp"
+#include "CpuTrace.hpp"
+#include "SymbolSource.hpp"
+#include "TraceHelper.hpp"
+
+//Converts binary CPU trace written by the emulator to the text trace, one line per instruction as in the history window.
+//Symbols of a lab file label addresses as set_label does in image script.
+//Usage: FelixTrace [-l lab file] [-t] trace [text]
+//  -t prefixes lines with the tick of the instruction
+//  text defaults to trace with .txt appended
+
+namespace
+{
+
+struct Options
+{
+  std::filesystem::path labPath;
+  bool ticks = false;
+  std::filesystem::path tracePath;
+  std::filesystem::path textPath;
+};
+
+std::optional<Options> parse( int argc, char const* argv[] )
+{
+  Options options;
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string_view arg{ argv[i] };
+    if ( arg == "-l" && i + 1 < argc )
+    {
+      options.labPath = argv[++i];
+    }
+    else if ( arg == "-t" )
+    {
+      options.ticks = true;
+    }
+    else if ( options.tracePath.empty() )
+    {
+      options.tracePath = arg;
+    }
+    else if ( options.textPath.empty() )
+    {
+      options.textPath = arg;
+    }
+    else
+    {
+      return {};
+    }
+  }
+
+  if ( options.tracePath.empty() )
+    return {};
+
+  if ( options.textPath.empty() )
+    options.textPath = std::filesystem::path{ options.tracePath }.concat( ".txt" );
+
+  return options;
+}
+
+}
+
+int main( int argc, char const* argv[] )
+{
+  auto options = parse( argc, argv );
+  if ( !options )
+  {
+    fmt::print( "Usage: FelixTrace [-l lab file] [-t] trace [text]\n" );
+    return 1;
+  }
+
+  std::ifstream in{ options->tracePath, std::ios::binary };
+  CpuTrace::Header header{};
+  in.read( (char*)&header, sizeof( header ) );
+  if ( !in || header.magic != CpuTrace::MAGIC || header.version != CpuTrace::VERSION )
+  {
+    fmt::print( "{} is not a trace\n", options->tracePath.string() );
+    return 2;
+  }
+
+  std::ofstream out{ options->textPath };
+  if ( !out )
+  {
+    fmt::print( "Can't write {}\n", options->textPath.string() );
+    return 2;
+  }
+
+  TraceHelper traceHelper;
+  if ( !options->labPath.empty() )
+    SymbolSource{ options->labPath }.applyLabels( traceHelper );
+
+  CpuTrace record;
+  CPUState before{};
+  CPUState after{};
+  std::string comment;
+  std::vector<char> buf;
+  uint64_t records = 0;
+
+  //a record cut off by interrupted emulation is ignored
+  while ( in.read( (char*)&record, sizeof( record ) ) )
+  {
+    comment.resize( record.commentSize );
+    if ( !in.read( comment.data(), comment.size() ) )
+      break;
+
+    record.restore( before, after );
+    buf.resize( CPU::TRACE_LINE_SIZE + comment.size() );
+    std::string_view commentView{ comment };
+    auto off = CPU::formatTrace( buf.data(), before, after, traceHelper, commentView.empty() ? nullptr : &commentView );
+
+    if ( options->ticks )
+      out << record.tick << '\t';
+    out.write( buf.data(), off );
+    out.put( '\n' );
+    records += 1;
+  }
+
+  fmt::print( "{} instructions written to {}\n", records, options->textPath.string() );
+  return 0;
+}
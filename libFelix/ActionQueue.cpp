@@ -1,5 +1,7 @@
 #include "pch.hpp"
 #include "ActionQueue.hpp"
+#include "Snapshot.hpp"
+#include "PerfCounters.hpp"
 
 SequencedAction::SequencedAction() : mData{}
 {
@@ -29,12 +31,13 @@ SequencedAction::operator bool() const
   return mData != 0;
 }
 
-ActionQueue::ActionQueue() : mHeap{}
+ActionQueue::ActionQueue() : mHeap{}, mPushes{}, mPops{}
 {
 }
 
 void ActionQueue::push( SequencedAction action )
 {
+  perfCount( mPushes[(size_t)action.getAction()] );
   mHeap.push_back( action );
   std::push_heap( mHeap.begin(), mHeap.end() );
 }
@@ -47,6 +50,7 @@ SequencedAction ActionQueue::pop()
 
     auto result = mHeap.back();
     mHeap.pop_back();
+    perfCount( mPops[(size_t)result.getAction()] );
     return result;
   }
   else
@@ -76,3 +80,20 @@ bool ActionQueue::empty() const
 {
   return mHeap.empty();
 }
+
+void ActionQueue::serialize( Snapshot & snapshot )
+{
+  snapshot.section( "ACTQ" );
+  //heap order is stored as is
+  snapshot( mHeap );
+}
+
+std::array<uint64_t, (size_t)Action::ACTIONS_END_> const& ActionQueue::pushes() const
+{
+  return mPushes;
+}
+
+std::array<uint64_t, (size_t)Action::ACTIONS_END_> const& ActionQueue::pops() const
+{
+  return mPops;
+}
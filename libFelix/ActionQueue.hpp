@@ -1,5 +1,7 @@
 #pragma once
 
+class Snapshot;
+
 static constexpr uint64_t TICK_PERIOD_LOG = 8;
 static constexpr uint64_t TICK_PERIOD = 1 << TICK_PERIOD_LOG;
 
@@ -64,9 +66,16 @@ public:
   uint64_t headTick() const;
   void erase( Action action );
   bool empty() const;
+  void serialize( Snapshot & snapshot );
+
+  //per action, counted only with performance counters
+  std::array<uint64_t, (size_t)Action::ACTIONS_END_> const& pushes() const;
+  std::array<uint64_t, (size_t)Action::ACTIONS_END_> const& pops() const;
 
 private:
 
   std::vector<SequencedAction> mHeap;
+  std::array<uint64_t, (size_t)Action::ACTIONS_END_> mPushes;
+  std::array<uint64_t, (size_t)Action::ACTIONS_END_> mPops;
 };
 
@@ -2,8 +2,9 @@
 #include "AudioChannel.hpp"
 #include "TimerCore.hpp"
 #include "Utility.hpp"
+#include "Snapshot.hpp"
 
-AudioChannel::AudioChannel( TimerCore& timer ) : mTimer{ timer }, mChangeCycle{}, mShiftRegisterBackup{}, mShiftRegister{}, mTapSelector{}, mParity{ ~0u }, mEnableIntegrate{}, mVolume{}, mOutput{}, mOldOutput{}
+AudioChannel::AudioChannel( TimerCore& timer ) : mTimer{ timer }, mChangeCycle{}, mShiftRegisterBackup{}, mShiftRegister{}, mTapSelector{}, mParity{ ~0u }, mEnableIntegrate{}, mEven{}, mVolume{}, mOutput{}, mOldOutput{}
 {
 }
 
@@ -138,3 +139,8 @@ void AudioChannel::trigger( uint64_t tick )
   }
 
 }
+
+void AudioChannel::serialize( Snapshot & snapshot )
+{
+  snapshot( mChangeCycle, mShiftRegisterBackup, mShiftRegister, mTapSelector, mParity, mEnableIntegrate, mEven, mVolume, mOutput, mOldOutput );
+}
@@ -3,6 +3,7 @@
 #include "ActionQueue.hpp"
 
 class TimerCore;
+class Snapshot;
 
 class AudioChannel
 {
@@ -31,6 +32,8 @@ public:
 
   void trigger( uint64_t tick );
 
+  void serialize( Snapshot & snapshot );
+
 private:
   static float sampleHelper( uint32_t diff );
 
@@ -0,0 +1,495 @@
+#include "pch.hpp"
+#include "BreakpointCondition.hpp"
+#include "SymbolTable.hpp"
+#include "Core.hpp"
+#include "CPU.hpp"
+#include "CPUState.hpp"
+
+class BreakpointCondition::Parser
+{
+public:
+  Parser( std::string_view source, SymbolTable const* symbols, std::vector<Instruction> & code ) : mSource{ source }, mPos{}, mSymbols{ symbols }, mCode{ code }, mDepth{}, mNesting{}
+  {
+  }
+
+  void parse()
+  {
+    expression( 0 );
+    skipSpace();
+    if ( mPos != mSource.size() )
+      fail( "unexpected character" );
+  }
+
+private:
+  struct Binary
+  {
+    std::string_view token;
+    Op op;
+    int level;
+  };
+
+  //longest tokens first, levels from the loosest
+  static constexpr std::array<Binary, 18> BINARY{ {
+    { "||", Op::LOR, 0 },
+    { "&&", Op::LAND, 1 },
+    { "==", Op::EQ, 5 },
+    { "!=", Op::NE, 5 },
+    { "<=", Op::LE, 6 },
+    { ">=", Op::GE, 6 },
+    { "<<", Op::SHL, 7 },
+    { ">>", Op::SHR, 7 },
+    { "|", Op::OR, 2 },
+    { "^", Op::XOR, 3 },
+    { "&", Op::AND, 4 },
+    { "<", Op::LT, 6 },
+    { ">", Op::GT, 6 },
+    { "+", Op::ADD, 8 },
+    { "-", Op::SUB, 8 },
+    { "*", Op::MUL, 9 },
+    { "/", Op::DIV, 9 },
+    { "%", Op::MOD, 9 }
+  } };
+  static constexpr int LEVELS = 10;
+
+  void expression( int level )
+  {
+    if ( level == LEVELS )
+    {
+      unary();
+      return;
+    }
+
+    expression( level + 1 );
+    for ( ;; )
+    {
+      auto binary = peekBinary();
+      if ( !binary || binary->level != level )
+        return;
+      mPos += binary->token.size();
+      expression( level + 1 );
+      emit( binary->op );
+    }
+  }
+
+  //every nested operand passes here, so the recursion is bounded before it goes deeper
+  void unary()
+  {
+    if ( ++mNesting > MAX_DEPTH )
+      fail( "expression too complex" );
+
+    if ( accept( "-" ) )
+    {
+      unary();
+      emit( Op::NEG );
+    }
+    else if ( accept( "!" ) )
+    {
+      unary();
+      emit( Op::NOT );
+    }
+    else if ( accept( "~" ) )
+    {
+      unary();
+      emit( Op::CPL );
+    }
+    else
+    {
+      primary();
+    }
+    mNesting -= 1;
+  }
+
+  void primary()
+  {
+    skipSpace();
+    if ( accept( "(" ) )
+    {
+      expression( 0 );
+      expect( ")" );
+    }
+    else if ( accept( "$" ) )
+    {
+      emit( Op::PUSH, number( 16 ) );
+    }
+    else if ( accept( "%" ) )
+    {
+      emit( Op::PUSH, number( 2 ) );
+    }
+    else if ( mSource.substr( mPos, 2 ) == "0x" )
+    {
+      mPos += 2;
+      emit( Op::PUSH, number( 16 ) );
+    }
+    else if ( mPos < mSource.size() && std::isdigit( (uint8_t)mSource[mPos] ) )
+    {
+      emit( Op::PUSH, number( 10 ) );
+    }
+    else if ( mPos < mSource.size() && ( std::isalpha( (uint8_t)mSource[mPos] ) || mSource[mPos] == '_' ) )
+    {
+      name();
+    }
+    else
+    {
+      fail( "expected value" );
+    }
+  }
+
+  void name()
+  {
+    size_t begin = mPos;
+    while ( mPos < mSource.size() && ( std::isalnum( (uint8_t)mSource[mPos] ) || mSource[mPos] == '_' ) )
+    {
+      mPos += 1;
+    }
+    auto id = mSource.substr( begin, mPos - begin );
+
+    static constexpr std::array<std::pair<std::string_view, Op>, 5> MEMORY{ {
+      { "ram", Op::RAM },
+      { "rom", Op::ROM },
+      { "mikey", Op::MIKEY },
+      { "suzy", Op::SUZY },
+      { "word", Op::WORD }
+    } };
+    static constexpr std::array<std::pair<std::string_view, Op>, 11> VALUES{ {
+      { "a", Op::A },
+      { "x", Op::X },
+      { "y", Op::Y },
+      { "s", Op::S },
+      { "p", Op::P },
+      { "pc", Op::PC },
+      { "value", Op::VALUE },
+      { "address", Op::ADDRESS },
+      { "tick", Op::TICK },
+      { "frame", Op::FRAME },
+      { "hits", Op::HITS }
+    } };
+    static constexpr std::array<std::pair<std::string_view, uint8_t>, 6> FLAGS{ {
+      { "c", CPUState::bitC },
+      { "z", CPUState::bitZ },
+      { "i", CPUState::bitI },
+      { "d", CPUState::bitD },
+      { "v", CPUState::bitV },
+      { "n", CPUState::bitN }
+    } };
+
+    if ( auto it = std::ranges::find( MEMORY, id, &std::pair<std::string_view, Op>::first ); it != MEMORY.cend() )
+    {
+      expect( "[" );
+      expression( 0 );
+      expect( "]" );
+      emit( it->second );
+    }
+    else if ( auto it = std::ranges::find( VALUES, id, &std::pair<std::string_view, Op>::first ); it != VALUES.cend() )
+    {
+      emit( it->second );
+    }
+    else if ( auto it = std::ranges::find( FLAGS, id, &std::pair<std::string_view, uint8_t>::first ); it != FLAGS.cend() )
+    {
+      emit( Op::FLAG, it->second );
+    }
+    else if ( auto address = mSymbols ? mSymbols->address( id ) : std::nullopt )
+    {
+      emit( Op::PUSH, *address );
+    }
+    else
+    {
+      fail( fmt::format( "unknown name {}", id ) );
+    }
+  }
+
+  int64_t number( int base )
+  {
+    int64_t result = 0;
+    size_t begin = mPos;
+    while ( mPos < mSource.size() )
+    {
+      char c = (char)std::tolower( (uint8_t)mSource[mPos] );
+      int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : base;
+      if ( digit >= base )
+        break;
+      if ( result > ( std::numeric_limits<int64_t>::max() - digit ) / base )
+        fail( "number too large" );
+      result = result * base + digit;
+      mPos += 1;
+    }
+    if ( mPos == begin )
+      fail( "expected digits" );
+    return result;
+  }
+
+  std::optional<Binary> peekBinary()
+  {
+    skipSpace();
+    for ( auto const& binary : BINARY )
+    {
+      if ( mSource.substr( mPos, binary.token.size() ) == binary.token )
+        return binary;
+    }
+    return {};
+  }
+
+  void emit( Op op, int64_t value = 0 )
+  {
+    switch ( op )
+    {
+    case Op::PUSH:
+    case Op::A:
+    case Op::X:
+    case Op::Y:
+    case Op::S:
+    case Op::P:
+    case Op::PC:
+    case Op::FLAG:
+    case Op::VALUE:
+    case Op::ADDRESS:
+    case Op::TICK:
+    case Op::FRAME:
+    case Op::HITS:
+      if ( ++mDepth > MAX_DEPTH )
+        fail( "expression too complex" );
+      break;
+    case Op::RAM:
+    case Op::ROM:
+    case Op::MIKEY:
+    case Op::SUZY:
+    case Op::WORD:
+    case Op::NEG:
+    case Op::NOT:
+    case Op::CPL:
+      break;
+    default:
+      mDepth -= 1;
+      break;
+    }
+    mCode.push_back( Instruction{ op, value } );
+  }
+
+  void skipSpace()
+  {
+    while ( mPos < mSource.size() && std::isspace( (uint8_t)mSource[mPos] ) )
+    {
+      mPos += 1;
+    }
+  }
+
+  bool accept( std::string_view token )
+  {
+    skipSpace();
+    if ( mSource.substr( mPos, token.size() ) != token )
+      return false;
+    mPos += token.size();
+    return true;
+  }
+
+  void expect( std::string_view token )
+  {
+    if ( !accept( token ) )
+      fail( fmt::format( "expected {}", token ) );
+  }
+
+  [[noreturn]] void fail( std::string const& message )
+  {
+    throw std::runtime_error{ fmt::format( "{} at {}", message, mPos + 1 ) };
+  }
+
+private:
+  std::string_view mSource;
+  size_t mPos;
+  SymbolTable const* mSymbols;
+  std::vector<Instruction> & mCode;
+  size_t mDepth;
+  size_t mNesting;
+};
+
+std::optional<BreakpointCondition> BreakpointCondition::compile( std::string_view source, SymbolTable const* symbols, std::string & error )
+{
+  BreakpointCondition result;
+  result.mSource = source;
+
+  try
+  {
+    Parser{ source, symbols, result.mCode }.parse();
+  }
+  catch ( std::runtime_error const& ex )
+  {
+    error = ex.what();
+    return {};
+  }
+
+  return result;
+}
+
+bool BreakpointCondition::evaluate( Core & core, uint16_t address, uint8_t value, uint64_t hits ) const
+{
+  auto const& state = core.debugState();
+  std::array<int64_t, MAX_DEPTH> stack;
+  //index of the next free entry
+  size_t top = 0;
+
+  for ( auto const& instruction : mCode )
+  {
+    switch ( instruction.op )
+    {
+    case Op::PUSH:
+      stack[top++] = instruction.value;
+      break;
+    case Op::A:
+      stack[top++] = state.a;
+      break;
+    case Op::X:
+      stack[top++] = state.x;
+      break;
+    case Op::Y:
+      stack[top++] = state.y;
+      break;
+    case Op::S:
+      stack[top++] = state.sl;
+      break;
+    case Op::P:
+      stack[top++] = state.getP();
+      break;
+    case Op::PC:
+      stack[top++] = state.pc;
+      break;
+    case Op::FLAG:
+      stack[top++] = ( state.getP() & instruction.value ) != 0;
+      break;
+    case Op::VALUE:
+      stack[top++] = value;
+      break;
+    case Op::ADDRESS:
+      stack[top++] = address;
+      break;
+    case Op::TICK:
+      stack[top++] = (int64_t)core.tick();
+      break;
+    case Op::FRAME:
+      stack[top++] = (int64_t)core.frameCount();
+      break;
+    case Op::HITS:
+      stack[top++] = (int64_t)hits;
+      break;
+    case Op::RAM:
+      stack[top - 1] = core.debugReadRAM( (uint16_t)stack[top - 1] );
+      break;
+    case Op::ROM:
+      stack[top - 1] = core.debugReadROM( (uint16_t)stack[top - 1] );
+      break;
+    case Op::MIKEY:
+      stack[top - 1] = core.debugReadMikey( (uint16_t)( 0xfd00 | ( stack[top - 1] & 0xff ) ) );
+      break;
+    case Op::SUZY:
+      stack[top - 1] = core.debugReadSuzy( (uint16_t)( 0xfc00 | ( stack[top - 1] & 0xff ) ) );
+      break;
+    case Op::WORD:
+      stack[top - 1] = core.debugReadRAM( (uint16_t)stack[top - 1] ) | ( core.debugReadRAM( (uint16_t)( stack[top - 1] + 1 ) ) << 8 );
+      break;
+    case Op::NEG:
+      stack[top - 1] = (int64_t)( 0 - (uint64_t)stack[top - 1] );
+      break;
+    case Op::NOT:
+      stack[top - 1] = !stack[top - 1];
+      break;
+    case Op::CPL:
+      stack[top - 1] = ~stack[top - 1];
+      break;
+    default:
+      {
+        int64_t right = stack[--top];
+        int64_t & left = stack[top - 1];
+        switch ( instruction.op )
+        {
+        //wrapping arithmetic, signed overflow is undefined
+        case Op::MUL:
+          left = (int64_t)( (uint64_t)left * (uint64_t)right );
+          break;
+        case Op::DIV:
+          //-1 negates with wrap around as INT64_MIN / -1 overflows
+          left = right == -1 ? (int64_t)( 0 - (uint64_t)left ) : right ? left / right : 0;
+          break;
+        case Op::MOD:
+          left = right == -1 || right == 0 ? 0 : left % right;
+          break;
+        case Op::ADD:
+          left = (int64_t)( (uint64_t)left + (uint64_t)right );
+          break;
+        case Op::SUB:
+          left = (int64_t)( (uint64_t)left - (uint64_t)right );
+          break;
+        case Op::SHL:
+          left <<= ( right & 63 );
+          break;
+        case Op::SHR:
+          left >>= ( right & 63 );
+          break;
+        case Op::LT:
+          left = left < right;
+          break;
+        case Op::LE:
+          left = left <= right;
+          break;
+        case Op::GT:
+          left = left > right;
+          break;
+        case Op::GE:
+          left = left >= right;
+          break;
+        case Op::EQ:
+          left = left == right;
+          break;
+        case Op::NE:
+          left = left != right;
+          break;
+        case Op::AND:
+          left &= right;
+          break;
+        case Op::XOR:
+          left ^= right;
+          break;
+        case Op::OR:
+          left |= right;
+          break;
+        case Op::LAND:
+          left = left && right;
+          break;
+        case Op::LOR:
+          left = left || right;
+          break;
+        default:
+          assert( false );
+          break;
+        }
+      }
+      break;
+    }
+  }
+
+  return top == 1 && stack[0] != 0;
+}
+
+std::string const& BreakpointCondition::source() const
+{
+  return mSource;
+}
+
+ConditionalBreakpointTrap::ConditionalBreakpointTrap( BreakpointCondition condition, Kind kind ) : mCondition{ std::move( condition ) }, mKind{ kind }, mHits{}
+{
+}
+
+uint8_t ConditionalBreakpointTrap::trap( Core & core, uint16_t address, uint8_t orgValue )
+{
+  mHits += 1;
+  if ( mCondition.evaluate( core, address, orgValue, mHits ) )
+    core.debugCPU().breakFromTrap();
+  return orgValue;
+}
+
+IMemoryAccessTrap::Kind ConditionalBreakpointTrap::getKind() const
+{
+  return mKind;
+}
+
+BreakpointCondition const& ConditionalBreakpointTrap::condition() const
+{
+  return mCondition;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "IMemoryAccessTrap.hpp"
+
+class SymbolTable;
+
+//Breakpoint condition compiled to postfix code evaluated natively at each trapped access.
+//Expressions use C operators and precedence on 64 bit signed values and may refer to:
+//  a x y s p pc              CPU registers
+//  c z i d v n               CPU flags
+//  value address             trapped value and address
+//  tick frame hits           emulated tick, frame count and number of times the trap was reached
+//  ram[e] rom[e] mikey[e] suzy[e] word[e]
+//                            memory bytes and little endian RAM words
+//Numbers are decimal, $ or 0x hexadecimal or % binary. Other names are symbols.
+class BreakpointCondition
+{
+public:
+  static std::optional<BreakpointCondition> compile( std::string_view source, SymbolTable const* symbols, std::string & error );
+
+  bool evaluate( Core & core, uint16_t address, uint8_t value, uint64_t hits ) const;
+  std::string const& source() const;
+
+private:
+  static constexpr size_t MAX_DEPTH = 32;
+
+  enum class Op : uint8_t
+  {
+    PUSH,
+    A,
+    X,
+    Y,
+    S,
+    P,
+    PC,
+    FLAG,
+    VALUE,
+    ADDRESS,
+    TICK,
+    FRAME,
+    HITS,
+    RAM,
+    ROM,
+    MIKEY,
+    SUZY,
+    WORD,
+    NEG,
+    NOT,
+    CPL,
+    MUL,
+    DIV,
+    MOD,
+    ADD,
+    SUB,
+    SHL,
+    SHR,
+    LT,
+    LE,
+    GT,
+    GE,
+    EQ,
+    NE,
+    AND,
+    XOR,
+    OR,
+    LAND,
+    LOR
+  };
+
+  struct Instruction
+  {
+    Op op;
+    int64_t value;
+  };
+
+  class Parser;
+
+  std::string mSource;
+  std::vector<Instruction> mCode;
+};
+
+//Breaks emulation when the condition holds
+class ConditionalBreakpointTrap : public IMemoryAccessTrap
+{
+public:
+  ConditionalBreakpointTrap( BreakpointCondition condition, Kind kind );
+  ~ConditionalBreakpointTrap() override = default;
+
+  uint8_t trap( Core & core, uint16_t address, uint8_t orgValue ) override;
+  Kind getKind() const override;
+
+  BreakpointCondition const& condition() const;
+
+private:
+  BreakpointCondition mCondition;
+  Kind mKind;
+  uint64_t mHits;
+};
@@ -3,6 +3,9 @@
 #include "Opcodes.hpp"
 #include "TraceHelper.hpp"
 #include "DebugRAM.hpp"
+#include "Snapshot.hpp"
+#include "CpuTrace.hpp"
+#include "Profiler.hpp"
 #include <stdarg.h>
 
 namespace
@@ -180,6 +183,55 @@ consteval uint32_t l4( char const ( &t )[N] )
 
 }
 
+//Ring of executed instructions written by emulation and read by debugger without locking.
+//Slots are read optimistically, a slot overwritten while being read is detected by its sequence number.
+struct CPU::History
+{
+  static constexpr uint64_t CAPACITY = 256;
+  //comment beyond row width is never shown
+  static constexpr size_t COMMENT_SIZE = 64;
+
+  struct Slot
+  {
+    //odd while being written, 2 * ( position + 1 ) when holding instruction at position
+    std::atomic<uint64_t> sequence;
+    CpuTrace trace;
+    char comment[COMMENT_SIZE];
+  };
+
+  History() : slots{ std::make_unique<Slot[]>( CAPACITY ) }, position{}, columns{}, rows{}
+  {
+  }
+
+  void push( CpuTrace trace, std::string_view comment )
+  {
+    uint64_t pos = position.load( std::memory_order_relaxed );
+    Slot & slot = slots[pos % CAPACITY];
+    slot.sequence.store( 2 * pos + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    trace.commentSize = (uint16_t)std::min( comment.size(), COMMENT_SIZE );
+    slot.trace = trace;
+    std::copy_n( comment.data(), trace.commentSize, slot.comment );
+    slot.sequence.store( 2 * pos + 2, std::memory_order_release );
+    position.store( pos + 1, std::memory_order_release );
+  }
+
+  bool read( uint64_t pos, CpuTrace & trace, std::array<char, COMMENT_SIZE> & comment ) const
+  {
+    Slot const& slot = slots[pos % CAPACITY];
+    uint64_t sequence = slot.sequence.load( std::memory_order_acquire );
+    trace = slot.trace;
+    std::copy_n( slot.comment, COMMENT_SIZE, comment.data() );
+    std::atomic_thread_fence( std::memory_order_acquire );
+    return sequence == 2 * pos + 2 && slot.sequence.load( std::memory_order_relaxed ) == sequence;
+  }
+
+  std::unique_ptr<Slot[]> slots;
+  std::atomic<uint64_t> position;
+  std::atomic<int> columns;
+  std::atomic<int> rows;
+};
+
 bool CPU::isHiccup()
 {
   switch ( mState.op )
@@ -223,9 +275,14 @@ bool CPU::isHiccup()
   }
 }
 
-void CPU::setLog( std::filesystem::path const & path )
+void CPU::setLog( std::unique_ptr<CpuTraceWriter> writer )
+{
+  mTraceWriter = std::move( writer );
+}
+
+void CPU::setProfiler( Profiler * profiler )
 {
-  mFtrace = std::ofstream{ path };
+  mProfiler = profiler;
 }
 
 CPUState & CPU::state()
@@ -233,11 +290,35 @@ CPUState & CPU::state()
   return mState;
 }
 
-CPU::CPU( std::shared_ptr<TraceHelper> traceHelper ) : mState{ CPUState::reset() }, mEx{ execute() }, mReq{}, mRes{ mState }, mTrace{}, mTraceToggle{}, mGlobalTrace{}, mFtrace{}, mTraceHelper{ std::move( traceHelper ) }, mHistory{}, mHistoryPresent{}, off{},
-  mPostponedStepOut{}, mStackBreakCondition{ 0xffff }, mBreakOnBrk{ false }
+uint16_t CPU::instructionPC() const
+{
+  return mPreviousState.pc;
+}
+
+bool CPU::atInstructionBoundary() const
+{
+  return ( mStarted || mResumeFetched ) && mReq.type == Request::Type::FETCH_OPCODE;
+}
+
+void CPU::serialize( Snapshot & snapshot )
+{
+  assert( !snapshot.saving() || atInstructionBoundary() );
+
+  snapshot.section( "CPU " );
+  snapshot( mState, mPreviousState, mReq.address, mReq.value, mReq.type, mRes.interrupt, mRes.value );
+
+  if ( snapshot.loading() )
+  {
+    //coroutine frame can't be serialized, but at instruction boundary it holds nothing besides its resume point
+    mResumeFetched = true;
+    mStarted = false;
+    mEx = execute();
+  }
+}
+
+CPU::CPU( std::shared_ptr<TraceHelper> traceHelper, uint64_t seed ) : mState{ CPUState::reset( seed ) }, mPreviousState{ mState }, mEx{ execute() }, mReq{}, mRes{ mState }, mTrace{}, mTraceToggle{}, mGlobalTrace{}, mTraceWriter{}, mProfiler{}, mTraceHelper{ std::move( traceHelper ) }, mHistory{}, mHistoryPresent{},
+  mPostponedStepOut{}, mStackBreakCondition{ 0xffff }, mBreakOnBrk{ false }, mStarted{}, mResumeFetched{}
 {
-  static constexpr char prototype[] = "PC:ffff A:ff X:ff Y:ff S:1ff P=NVDIZC ";
-  memcpy( &buf[0], prototype, sizeof prototype );
 }
 
 CPU::~CPU()
@@ -323,6 +404,12 @@ CPU::Execute::Execute( handle c ) : coro{ c }
 {
 }
 
+CPU::Execute & CPU::Execute::operator=( Execute && other )
+{
+  std::swap( coro, other.coro );
+  return *this;
+}
+
 CPU::Execute::~Execute()
 {
   if ( coro )
@@ -334,6 +421,17 @@ CPU::Execute::~Execute()
 CPU::Execute CPU::execute()
 {
   auto& state = mState;
+  mStarted = true;
+
+  if ( mResumeFetched )
+  {
+    //what fetchOpcode awaiter would do on resume
+    mResumeFetched = false;
+    state.interrupt = mRes.interrupt;
+    state.op = (Opcode)mRes.value;
+    goto opcodeFetched;
+  }
+
   mPreviousState = state;
 
   trace1();
@@ -2118,6 +2216,7 @@ CPU::Execute CPU::execute()
     do
     {
       co_await fetchOpcode( state.pc );
+    opcodeFetched:
       mPreviousState = state;
       trace1();
       state.pc += 1;
@@ -2128,27 +2227,8 @@ CPU::Execute CPU::execute()
 
 void CPU::trace1()
 {
-  if ( mGlobalTrace )
-  {
-    buf[3] = hexTab[mPreviousState.pch >> 4];
-    buf[4] = hexTab[mPreviousState.pch & 0x0f];
-    buf[5] = hexTab[mPreviousState.pcl >> 4];
-    buf[6] = hexTab[mPreviousState.pcl & 0x0f];
-
-    buf[10] = hexTab[mPreviousState.a >> 4];
-    buf[11] = hexTab[mPreviousState.a & 0x0f];
-    buf[15] = hexTab[mPreviousState.x >> 4];
-    buf[16] = hexTab[mPreviousState.x & 0x0f];
-    buf[20] = hexTab[mPreviousState.y >> 4];
-    buf[21] = hexTab[mPreviousState.y & 0x0f];
-
-    buf[26] = hexTab[mPreviousState.sl >> 4];
-    buf[27] = hexTab[mPreviousState.sl & 0x0f];
-
-    mPreviousState.printP( (char*)&buf[31] );
-
-    off = 38;
-  }
+  if ( mGlobalTrace && mTraceWriter )
+    mTraceWriter->start();
 }
 
 void CPU::printStatus( std::span<uint8_t,3*14> text )
@@ -2195,9 +2275,11 @@ void CPU::disassemblyFromPC( uint8_t const* ram, char* out, int columns, int row
 
 void CPU::enableHistory( int columns, int rows )
 {
-  std::scoped_lock<std::mutex> l{ mHistoryMutex };
-  mHistory.reset( new History( columns, rows, 0, std::vector<char>{} ) );
-  mHistory->data.resize( columns * rows );
+  //ring is kept once created, so emulation never sees it go away
+  if ( !mHistory )
+    mHistory = std::make_unique<History>();
+  mHistory->columns.store( columns );
+  mHistory->rows.store( rows );
   mHistoryPresent.store( true );
   setGlobalTrace();
 }
@@ -2205,18 +2287,44 @@ void CPU::enableHistory( int columns, int rows )
 void CPU::disableHistory()
 {
   mHistoryPresent.store( false );
-  std::scoped_lock<std::mutex> l{ mHistoryMutex };
-  mHistory.reset();
   setGlobalTrace();
 }
 
 void CPU::copyHistory( std::span<char> out )
 {
-  if ( mHistoryPresent.load() )
-    mHistory->copy( out );
+  if ( !mHistoryPresent.load() )
+    return;
+
+  size_t columns = (size_t)mHistory->columns.load();
+  size_t rows = std::min( (size_t)mHistory->rows.load(), out.size() / std::max<size_t>( columns, 1 ) );
+  uint64_t end = mHistory->position.load( std::memory_order_acquire );
+
+  CpuTrace trace;
+  std::array<char, History::COMMENT_SIZE> comment;
+  CPUState before{};
+  CPUState after{};
+  std::array<char, TRACE_LINE_SIZE + History::COMMENT_SIZE> line;
+
+  //only rows on screen are formatted, oldest first
+  for ( size_t i = 0; i < rows; ++i )
+  {
+    auto row = out.subspan( i * columns, columns );
+    uint64_t pos = end + i - rows;
+    if ( end + i < rows || rows - i > History::CAPACITY || !mHistory->read( pos, trace, comment ) )
+    {
+      std::ranges::fill( row, ' ' );
+      continue;
+    }
+
+    trace.restore( before, after );
+    std::string_view commentView{ comment.data(), trace.commentSize };
+    auto off = formatTrace( line.data(), before, after, *mTraceHelper, commentView.empty() ? nullptr : &commentView );
+    auto it = std::copy_n( line.cbegin(), std::min( row.size(), (size_t)off ), row.begin() );
+    std::fill( it, row.end(), ' ' );
+  }
 }
 
-bool CPU::disasmOp( char * out, Opcode op, CPUState* state )
+bool CPU::disasmOp( char * out, Opcode op, CPUState const* state )
 {
   bool defined = true;
   out[4] = ' '; /* Hack for history */
@@ -3167,17 +3275,34 @@ uint8_t CPU::disasmOpr( uint8_t const* ram, char* out, int & pc )
   return pc - intialPC;
 }
 
-void CPU::trace2()
+int64_t CPU::formatTrace( char * out, CPUState const& before, CPUState const& after, TraceHelper const& traceHelper, std::string_view const* comment )
 {
-  if ( !mGlobalTrace )
-    return;
+  static constexpr char prototype[] = "PC:ffff A:ff X:ff Y:ff S:1ff P=NVDIZC ";
+  memcpy( out, prototype, sizeof prototype );
 
-  disasmOp( buf.data() + off, mState.op, &mState );
-  off += 5;
+  out[3] = hexTab[before.pch >> 4];
+  out[4] = hexTab[before.pch & 0x0f];
+  out[5] = hexTab[before.pcl >> 4];
+  out[6] = hexTab[before.pcl & 0x0f];
 
-  auto comment = mTraceHelper->getTraceComment();
+  out[10] = hexTab[before.a >> 4];
+  out[11] = hexTab[before.a & 0x0f];
+  out[15] = hexTab[before.x >> 4];
+  out[16] = hexTab[before.x & 0x0f];
+  out[20] = hexTab[before.y >> 4];
+  out[21] = hexTab[before.y & 0x0f];
 
-  switch ( mState.op )
+  out[26] = hexTab[before.sl >> 4];
+  out[27] = hexTab[before.sl & 0x0f];
+
+  before.printP( out + 31 );
+
+  int64_t off = 38;
+
+  disasmOp( out + off, after.op, &after );
+  off += 5;
+
+  switch ( after.op )
   {
   case Opcode::UND_1_03:
   case Opcode::UND_1_13:
@@ -3224,7 +3349,7 @@ void CPU::trace2()
   case Opcode::RZP_ORA:
   case Opcode::RZP_ADC:
   case Opcode::RZP_SBC:
-    off += sprintf( buf.data() + off, "$%02x\t;$%02x", mState.eal, mState.m1 );
+    off += sprintf( out + off, "$%02x\t;$%02x", after.eal, after.m1 );
     break;
   case Opcode::MZP_ASL:
   case Opcode::MZP_DEC:
@@ -3250,14 +3375,14 @@ void CPU::trace2()
   case Opcode::MZP_SMB5:
   case Opcode::MZP_SMB6:
   case Opcode::MZP_SMB7:
-    off += sprintf( buf.data() + off, "$%02x\t;$%02x->$%02x", mState.eal, mState.m1, mState.m2 );
+    off += sprintf( out + off, "$%02x\t;$%02x->$%02x", after.eal, after.m1, after.m2 );
     break;
   case Opcode::WZP_STA:
   case Opcode::WZP_STX:
   case Opcode::WZP_STY:
   case Opcode::WZP_STZ:
   case Opcode::UND_3_44:
-    off += sprintf( buf.data() + off, "$%02x", mState.eal );
+    off += sprintf( out + off, "$%02x", after.eal );
     break;
   case Opcode::RZX_LDA:
   case Opcode::RZX_LDY:
@@ -3268,7 +3393,7 @@ void CPU::trace2()
   case Opcode::RZX_ORA:
   case Opcode::RZX_ADC:
   case Opcode::RZX_SBC:
-    off += sprintf( buf.data() + off, "$%02x,x\t;[$%04x]=$%02x", mState.eal, mState.t, mState.m1 );
+    off += sprintf( out + off, "$%02x,x\t;[$%04x]=$%02x", after.eal, after.t, after.m1 );
     break;
   case Opcode::MZX_ASL:
   case Opcode::MZX_DEC:
@@ -3276,7 +3401,7 @@ void CPU::trace2()
   case Opcode::MZX_LSR:
   case Opcode::MZX_ROL:
   case Opcode::MZX_ROR:
-    off += sprintf( buf.data() + off, "$%02x,x\t;[$%04x]=$%02x->$%02x", mState.eal, mState.t, mState.m1, mState.m2 );
+    off += sprintf( out + off, "$%02x,x\t;[$%04x]=$%02x->$%02x", after.eal, after.t, after.m1, after.m2 );
     break;
   case Opcode::WZX_STA:
   case Opcode::WZX_STY:
@@ -3284,13 +3409,13 @@ void CPU::trace2()
   case Opcode::UND_4_54:
   case Opcode::UND_4_d4:
   case Opcode::UND_4_f4:
-    off += sprintf( buf.data() + off, "$%02x,x\t;[$%04x]", mState.eal, mState.t );
+    off += sprintf( out + off, "$%02x,x\t;[$%04x]", after.eal, after.t );
     break;
   case Opcode::RZY_LDX:
-    off += sprintf( buf.data() + off, "$%02x,y\t;[$%04x]=$%02x", mState.eal, mState.t, mState.m1 );
+    off += sprintf( out + off, "$%02x,y\t;[$%04x]=$%02x", after.eal, after.t, after.m1 );
     break;
   case Opcode::WZY_STX:
-    off += sprintf( buf.data() + off, "$%02x,y\t;[$%04x]", mState.eal, mState.t );
+    off += sprintf( out + off, "$%02x,y\t;[$%04x]", after.eal, after.t );
     break;
   case Opcode::RIN_LDA:
   case Opcode::RIN_AND:
@@ -3301,21 +3426,21 @@ void CPU::trace2()
   case Opcode::RIN_SBC:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "({:02x})\t;[{}]={:02x}\t{}", mState.fa, mTraceHelper->addressLabel( mState.t ), mState.m1, *comment ) - buf.data();
+      off = fmt::format_to( out + off, "({:02x})\t;[{}]={:02x}\t{}", after.fa, traceHelper.addressLabel( after.t ), after.m1, *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "($%02x)\t;[%s]=$%02x", mState.fa, mTraceHelper->addressLabel( mState.t ), mState.m1 );
+      off += sprintf( out + off, "($%02x)\t;[%s]=$%02x", after.fa, traceHelper.addressLabel( after.t ), after.m1 );
     }
     break;
   case Opcode::WIN_STA:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "({:02x})\t;[{}]\t{}", mState.fa, mTraceHelper->addressLabel( mState.t ), *comment ) - buf.data();
+      off = fmt::format_to( out + off, "({:02x})\t;[{}]\t{}", after.fa, traceHelper.addressLabel( after.t ), *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "($%02x)\t;[%s]", mState.fa, mTraceHelper->addressLabel( mState.t ) );
+      off += sprintf( out + off, "($%02x)\t;[%s]", after.fa, traceHelper.addressLabel( after.t ) );
     }
     break;
   case Opcode::RIX_AND:
@@ -3327,21 +3452,21 @@ void CPU::trace2()
   case Opcode::RIX_SBC:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "({:02x},x)\t;[{}]={:02x}\t{}", mState.fa, mTraceHelper->addressLabel( mState.t ), mState.m1, *comment ) - buf.data();
+      off = fmt::format_to( out + off, "({:02x},x)\t;[{}]={:02x}\t{}", after.fa, traceHelper.addressLabel( after.t ), after.m1, *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "($%02x,x)\t;[%s]=$%02x", mState.fa, mTraceHelper->addressLabel( mState.t ), mState.m1 );
+      off += sprintf( out + off, "($%02x,x)\t;[%s]=$%02x", after.fa, traceHelper.addressLabel( after.t ), after.m1 );
     }
     break;
   case Opcode::WIX_STA:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "({:02x},x)\t;[{}]\t{}", mState.fa, mTraceHelper->addressLabel( mState.t ), *comment ) - buf.data();
+      off = fmt::format_to( out + off, "({:02x},x)\t;[{}]\t{}", after.fa, traceHelper.addressLabel( after.t ), *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "($%02x,x)\t;[%s]", mState.fa, mTraceHelper->addressLabel( mState.t ) );
+      off += sprintf( out + off, "($%02x,x)\t;[%s]", after.fa, traceHelper.addressLabel( after.t ) );
     }
     break;
   case Opcode::RIY_AND:
@@ -3353,21 +3478,21 @@ void CPU::trace2()
   case Opcode::RIY_SBC:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "({:02x}),y\t;[{}]={:02x}\t{}", mState.fa, mTraceHelper->addressLabel( mState.ea ), mState.m1, *comment ) - buf.data();
+      off = fmt::format_to( out + off, "({:02x}),y\t;[{}]={:02x}\t{}", after.fa, traceHelper.addressLabel( after.ea ), after.m1, *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "($%02x),y\t;[%s]=$%02x", mState.fa, mTraceHelper->addressLabel( mState.ea ), mState.m1 );
+      off += sprintf( out + off, "($%02x),y\t;[%s]=$%02x", after.fa, traceHelper.addressLabel( after.ea ), after.m1 );
     }
     break;
   case Opcode::WIY_STA:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "({:02x}),y\t;[{}]\t{}", mState.fa, mTraceHelper->addressLabel( mState.ea ), *comment ) - buf.data();
+      off = fmt::format_to( out + off, "({:02x}),y\t;[{}]\t{}", after.fa, traceHelper.addressLabel( after.ea ), *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "($%02x),y\t;[%s]", mState.fa, mTraceHelper->addressLabel( mState.ea ) );
+      off += sprintf( out + off, "($%02x),y\t;[%s]", after.fa, traceHelper.addressLabel( after.ea ) );
     }
     break;
   case Opcode::RAB_AND:
@@ -3384,11 +3509,11 @@ void CPU::trace2()
   case Opcode::RAB_SBC:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "{}\t;={:02x}\t{}", mTraceHelper->addressLabel( mState.ea ), mState.m1, *comment ) - buf.data();
+      off = fmt::format_to( out + off, "{}\t;={:02x}\t{}", traceHelper.addressLabel( after.ea ), after.m1, *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "%s\t;=$%02x", mTraceHelper->addressLabel( mState.ea ), mState.m1 );
+      off += sprintf( out + off, "%s\t;=$%02x", traceHelper.addressLabel( after.ea ), after.m1 );
     }
     break;
   case Opcode::MAB_ASL:
@@ -3401,11 +3526,11 @@ void CPU::trace2()
   case Opcode::MAB_TSB:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "{}\t;={:02x}->{:02x}\t{}", mTraceHelper->addressLabel( mState.ea ), mState.m1, mState.m2, *comment ) - buf.data();
+      off = fmt::format_to( out + off, "{}\t;={:02x}->{:02x}\t{}", traceHelper.addressLabel( after.ea ), after.m1, after.m2, *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "%s\t;=$%02x->$%02x", mTraceHelper->addressLabel( mState.ea ), mState.m1, mState.m2 );
+      off += sprintf( out + off, "%s\t;=$%02x->$%02x", traceHelper.addressLabel( after.ea ), after.m1, after.m2 );
     }
     break;
   case Opcode::WAB_STA:
@@ -3414,11 +3539,11 @@ void CPU::trace2()
   case Opcode::WAB_STZ:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "{}\t;{}", mTraceHelper->addressLabel( mState.ea ), *comment ) - buf.data();
+      off = fmt::format_to( out + off, "{}\t;{}", traceHelper.addressLabel( after.ea ), *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "%s", mTraceHelper->addressLabel( mState.ea ) );
+      off += sprintf( out + off, "%s", traceHelper.addressLabel( after.ea ) );
     }
     break;
   case Opcode::JMA_JMP:
@@ -3426,7 +3551,7 @@ void CPU::trace2()
   case Opcode::UND_4_dc:
   case Opcode::UND_4_fc:
   case Opcode::UND_8_5c:
-    off += sprintf( buf.data() + off, "%s", mTraceHelper->addressLabel( mState.ea ) );
+    off += sprintf( out + off, "%s", traceHelper.addressLabel( after.ea ) );
     break;
   case Opcode::RAX_AND:
   case Opcode::RAX_BIT:
@@ -3439,11 +3564,11 @@ void CPU::trace2()
   case Opcode::RAX_SBC:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "{:04x},x\t;[{}]={:02x}\t{}", mState.ea, mTraceHelper->addressLabel( mState.fa ), mState.m1, *comment ) - buf.data();
+      off = fmt::format_to( out + off, "{:04x},x\t;[{}]={:02x}\t{}", after.ea, traceHelper.addressLabel( after.fa ), after.m1, *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "$%04x,x\t;[%s]=$%02x", mState.ea, mTraceHelper->addressLabel( mState.fa ), mState.m1 );
+      off += sprintf( out + off, "$%04x,x\t;[%s]=$%02x", after.ea, traceHelper.addressLabel( after.fa ), after.m1 );
     }
     break;
   case Opcode::MAX_ASL:
@@ -3454,22 +3579,22 @@ void CPU::trace2()
   case Opcode::MAX_ROR:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "{:04x},x\t;[{}]={:02x}->{:02x}\t{}", mState.ea, mTraceHelper->addressLabel( mState.fa ), mState.m1, mState.m2, *comment ) - buf.data();
+      off = fmt::format_to( out + off, "{:04x},x\t;[{}]={:02x}->{:02x}\t{}", after.ea, traceHelper.addressLabel( after.fa ), after.m1, after.m2, *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "$%04x,x\t;[%s]=$%02x->$%02x", mState.ea, mTraceHelper->addressLabel( mState.fa ), mState.m1, mState.m2 );
+      off += sprintf( out + off, "$%04x,x\t;[%s]=$%02x->$%02x", after.ea, traceHelper.addressLabel( after.fa ), after.m1, after.m2 );
     }
     break;
   case Opcode::WAX_STA:
   case Opcode::WAX_STZ:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "{:04x},x\t;[{}]\t{}", mState.ea, mTraceHelper->addressLabel( mState.fa ), *comment ) - buf.data();
+      off = fmt::format_to( out + off, "{:04x},x\t;[{}]\t{}", after.ea, traceHelper.addressLabel( after.fa ), *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "$%04x,x\t;[%s]", mState.ea, mTraceHelper->addressLabel( mState.fa ) );
+      off += sprintf( out + off, "$%04x,x\t;[%s]", after.ea, traceHelper.addressLabel( after.fa ) );
     }
     break;
   case Opcode::RAY_AND:
@@ -3482,28 +3607,28 @@ void CPU::trace2()
   case Opcode::RAY_SBC:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "{:04x},y\t;[{}]={:02x}\t{}", mState.ea, mTraceHelper->addressLabel( mState.fa ), mState.m1, *comment ) - buf.data();
+      off = fmt::format_to( out + off, "{:04x},y\t;[{}]={:02x}\t{}", after.ea, traceHelper.addressLabel( after.fa ), after.m1, *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "$%04x,y\t;[%s]=$%02x", mState.ea, mTraceHelper->addressLabel( mState.fa ), mState.m1 );
+      off += sprintf( out + off, "$%04x,y\t;[%s]=$%02x", after.ea, traceHelper.addressLabel( after.fa ), after.m1 );
     }
     break;
   case Opcode::WAY_STA:
     if ( comment )
     {
-      off = fmt::format_to( buf.data() + off, "{:04x},y\t;[{}]\t{}", mState.ea, mTraceHelper->addressLabel( mState.fa ), *comment ) - buf.data();
+      off = fmt::format_to( out + off, "{:04x},y\t;[{}]\t{}", after.ea, traceHelper.addressLabel( after.fa ), *comment ) - out;
     }
     else
     {
-      off += sprintf( buf.data() + off, "$%04x,y\t;[%s]", mState.ea, mTraceHelper->addressLabel( mState.fa ) );
+      off += sprintf( out + off, "$%04x,y\t;[%s]", after.ea, traceHelper.addressLabel( after.fa ) );
     }
     break;
   case Opcode::JMX_JMP:
-    off += sprintf( buf.data() + off, "($%04x,x)\t;[%s]", mState.fa, mTraceHelper->addressLabel( mState.ea ) );
+    off += sprintf( out + off, "($%04x,x)\t;[%s]", after.fa, traceHelper.addressLabel( after.ea ) );
     break;
   case Opcode::JMI_JMP:
-    off += sprintf( buf.data() + off, "($%04x)\t;[%s]", mState.fa, mTraceHelper->addressLabel( mState.t ) );
+    off += sprintf( out + off, "($%04x)\t;[%s]", after.fa, traceHelper.addressLabel( after.t ) );
     break;
   case Opcode::IMP_ASL:
   case Opcode::IMP_CLC:
@@ -3560,7 +3685,7 @@ void CPU::trace2()
   case Opcode::UND_2_C2:
   case Opcode::UND_2_E2:
   case Opcode::BRK_BRK:
-    off += sprintf( buf.data() + off, "#$%02x", mState.eal );
+    off += sprintf( out + off, "#$%02x", after.eal );
     break;
   case Opcode::BRL_BCC:
   case Opcode::BRL_BCS:
@@ -3571,7 +3696,7 @@ void CPU::trace2()
   case Opcode::BRL_BVC:
   case Opcode::BRL_BVS:
   case Opcode::BRL_BRA:
-    off += sprintf( buf.data() + off, "$%04x", mState.t );
+    off += sprintf( out + off, "$%04x", after.t );
     break;
   case Opcode::BZR_BBR0:
   case Opcode::BZR_BBR1:
@@ -3589,25 +3714,31 @@ void CPU::trace2()
   case Opcode::BZR_BBS5:
   case Opcode::BZR_BBS6:
   case Opcode::BZR_BBS7:
-    off += sprintf( buf.data() + off, "$%02x,$%04x\t;$%02x", mState.eal, mState.t, mState.m1 );
+    off += sprintf( out + off, "$%02x,$%04x\t;$%02x", after.eal, after.t, after.m1 );
     break;
   }
 
-  if ( mFtrace.good() && ( mTrace || mTraceToggle ) )
-  {
-    mFtrace.write( buf.data(), off );
-    mFtrace.put( '\n' );
-  }
+  return off;
+}
+
+void CPU::trace2()
+{
+  if ( mProfiler )
+    mProfiler->retire( mPreviousState, mState );
+
+  if ( !mGlobalTrace )
+    return;
+
+  auto comment = mTraceHelper->getTraceComment();
+
+  if ( mTraceWriter && ( mTrace || mTraceToggle ) )
+    mTraceWriter->write( mPreviousState, mState, comment ? *comment : std::string_view{} );
 
   toggleTrace( false );
 
-  std::scoped_lock<std::mutex> l{ mHistoryMutex };
+  //history is formatted by debugger when shown, it has no use for ticks
   if ( mHistoryPresent.load() )
-  {
-    auto row = mHistory->nextRow();
-    auto it = std::copy_n( buf.cbegin(), (std::min)( row.size(), (size_t)off ), row.begin() );
-    std::fill( it, row.end(), ' ' );
-  }
+    mHistory->push( CpuTrace::make( 0, mPreviousState, mState, 0 ), comment ? *comment : std::string_view{} );
 }
 
 void CPU::enableTrace()
@@ -3622,6 +3753,9 @@ void CPU::disableTrace()
   mTraceHelper->enable( false );
   mTrace = false;
   setGlobalTrace();
+  //traced span is written without waiting for a full buffer
+  if ( mTraceWriter )
+    mTraceWriter->flush();
 }
 
 void CPU::toggleTrace( bool on )
@@ -3647,23 +3781,3 @@ void CPU::setGlobalTrace()
   }
 }
 
-
-std::span<char> CPU::History::nextRow()
-{
-  std::span<char> result = std::span<char>{ data.data() + cursor * columns, (size_t)columns };
-  cursor = ( cursor + 1 ) % rows;
-
-  return result;
-}
-
-void CPU::History::copy( std::span<char> out )
-{
-  int cur = cursor;
-  size_t i = 0;
-
-  do
-  {
-    std::copy_n( data.data() + cur * columns, columns, out.data() + i * columns );
-    cur = ( cur + 1 ) % rows;
-  } while ( ++i < rows );
-}
@@ -5,8 +5,11 @@
 
 enum class Opcode : uint8_t;
 struct CpuTrace;
+class CpuTraceWriter;
 struct TraceRequest;
 class TraceHelper;
+class Snapshot;
+class Profiler;
 
 class CPU
 {
@@ -46,7 +49,7 @@ public:
   };
 
 
-  CPU( std::shared_ptr<TraceHelper> traceHelper );
+  CPU( std::shared_ptr<TraceHelper> traceHelper, uint64_t seed );
   ~CPU();
 
   Request const& advance();
@@ -71,15 +74,27 @@ public:
   void assertInterrupt( int mask );
   void desertInterrupt( int mask );
   int interruptedMask() const;
-  void setLog( std::filesystem::path const & path );
+  void setLog( std::unique_ptr<CpuTraceWriter> writer );
+  //profiler is called after every instruction
+  void setProfiler( Profiler * profiler );
 
   CPUState & state();
+  //address of the instruction being executed
+  uint16_t instructionPC() const;
+
+  //true between instructions, after the opcode has been fetched. Only then CPU can be serialized
+  bool atInstructionBoundary() const;
+  void serialize( Snapshot & snapshot );
 
   void enableTrace();
   void disableTrace();
   void toggleTrace( bool on );
   void printStatus( std::span<uint8_t, 3 * 14> text );
-  static bool disasmOp( char* out, Opcode op, CPUState* state = nullptr );
+  static bool disasmOp( char* out, Opcode op, CPUState const* state = nullptr );
+  //room for a trace line besides its comment, labels being limited in size
+  static constexpr size_t TRACE_LINE_SIZE = 256;
+  //formats trace line of an instruction into out of TRACE_LINE_SIZE plus comment size, returns its length
+  static int64_t formatTrace( char * out, CPUState const& before, CPUState const& after, TraceHelper const& traceHelper, std::string_view const* comment );
   uint8_t disasmOpr( uint8_t const* ram, char* out, int& pc );
   void disassemblyFromPC( uint8_t const* ram, char * out, int columns, int rows );
   void enableHistory( int columns, int rows );
@@ -107,17 +122,19 @@ private:
 
     Execute();
     Execute( handle c );
+    Execute & operator=( Execute && other );
     ~Execute();
 
     handle coro;
-  } const mEx;
+  } mEx;
 
   Request mReq;
   Response mRes;
   bool mTrace;
   bool mTraceToggle;
   bool mGlobalTrace;
-  std::ofstream mFtrace;
+  std::unique_ptr<CpuTraceWriter> mTraceWriter;
+  Profiler * mProfiler;
   std::shared_ptr<TraceHelper> mTraceHelper;
 
   Execute execute();
@@ -192,25 +209,16 @@ private:
 
 private:
 
-  struct History
-  {
-    int columns;
-    int rows;
-    int cursor;
-    std::vector<char> data;
-
-    std::span<char> nextRow();
-    void copy( std::span<char> out );
-  };
+  struct History;
 
-  std::array<char, 1024> buf;
-  int64_t off;
   std::unique_ptr<History> mHistory;
-  std::mutex mHistoryMutex;
   std::atomic_bool mHistoryPresent;
   //true if mStackBreakCondition is valid for CpuBreakType::STEP_OUT
   bool mPostponedStepOut;
   uint16_t mStackBreakCondition;
   bool mBreakOnBrk;
+  bool mStarted;
+  //new coroutine continues from fetched opcode instead of the beginning
+  bool mResumeFetched;
 };
 
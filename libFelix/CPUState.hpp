@@ -73,29 +73,32 @@ struct CPUState
     out[7] = ' ';
   }
 
-  static CPUState reset()
+  //undefined power-on register values derived from seed. Engine output is specified by the standard, distributions are not
+  static CPUState reset( uint64_t seed )
   {
-    std::random_device r{};
-    std::default_random_engine e{r()};
-    std::uniform_int_distribution randomByte{ 0, 255 };
+    std::mt19937_64 e{ seed };
+    auto randomByte = [&]
+    {
+      return (uint8_t)( e() >> 56 );
+    };
 
     CPUState result;
-    result.n.set( randomByte( e ) > 127 );
-    result.v.set( randomByte( e ) > 127 );
+    result.n.set( randomByte() > 127 );
+    result.v.set( randomByte() > 127 );
     result.d.clear();
     result.i.set();
-    result.z.set( randomByte( e ) > 127 );
-    result.c.set( randomByte( e ) > 127 );
+    result.z.set( randomByte() > 127 );
+    result.c.set( randomByte() > 127 );
     result.padding = ' ';
     result.interrupt = (uint8_t)I_RESET;
-    result.pch = randomByte( e );
-    result.pcl = randomByte( e );
+    result.pch = randomByte();
+    result.pcl = randomByte();
     result.sh = 0x01;
-    result.sl = randomByte( e );
+    result.sl = randomByte();
     result.op = Opcode::BRK_BRK;
-    result.a = randomByte( e );
-    result.x = randomByte( e );
-    result.y = randomByte( e );
+    result.a = randomByte();
+    result.x = randomByte();
+    result.y = randomByte();
     result.ea = 0;
     result.fa = 0;
     result.t = 0;
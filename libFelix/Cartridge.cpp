@@ -3,6 +3,8 @@
 #include "GameDrive.hpp"
 #include "EEPROM.hpp"
 #include "TraceHelper.hpp"
+#include "Snapshot.hpp"
+#include "PerfCounters.hpp"
 
 Cartridge::Cartridge( ImageProperties const& imageProperties, std::shared_ptr<ImageCart const> cart, std::shared_ptr<TraceHelper> traceHelper ) :
   mTraceHelper{ std::move( traceHelper ) }, mCart{ std::move( cart ) }, mGameDrive{ GameDrive::create( imageProperties ) },
@@ -45,10 +47,17 @@ void Cartridge::setAudIn( bool value )
     return;
 
   mAudIn = value;
+  selectBanks();
+}
 
+void Cartridge::selectBanks()
+{
   if ( !mCart )
     return;
 
+  mBank0 = mCart->getBank0();
+  mBank1 = mCart->getBank1();
+
   if ( mAudIn )
   {
     auto bank0a = mCart->getBank0A();
@@ -60,11 +69,6 @@ void Cartridge::setAudIn( bool value )
     if ( !bank1a.empty() )
       mBank1 = bank1a;
   }
-  else
-  {
-    mBank0 = mCart->getBank0();
-    mBank1 = mCart->getBank1();
-  }
 }
 
 void Cartridge::setCartAddressData( bool value )
@@ -150,6 +154,31 @@ bool Cartridge::isCart1Inactive() const
   return true;
 }
 
+bool Cartridge::snapshotReady() const
+{
+  return !mEEPROM || mEEPROM->idle();
+}
+
+void Cartridge::addPerfCounters( PerfCounters & counters ) const
+{
+  if ( mEEPROM )
+    counters.resumes[(size_t)PerfCounters::Coroutine::EEPROM] += mEEPROM->resumes();
+  if ( mGameDrive )
+    counters.resumes[(size_t)PerfCounters::Coroutine::GAMEDRIVE] += mGameDrive->resumes();
+}
+
+void Cartridge::serialize( Snapshot & snapshot )
+{
+  snapshot.section( "CART" );
+  snapshot( mShiftRegister, mCounter, mAudIn, mCurrentStrobe, mAddressData );
+
+  if ( mEEPROM )
+    mEEPROM->serialize( snapshot );
+
+  if ( snapshot.loading() )
+    selectBanks();
+}
+
 
 uint8_t Cartridge::peek( CartBank const & bank )
 {
@@ -6,6 +6,8 @@ class GameDrive;
 class EEPROM;
 class TraceHelper;
 class ImageProperties;
+class Snapshot;
+struct PerfCounters;
 
 class Cartridge
 {
@@ -30,8 +32,15 @@ public:
   bool isCart0Inactive() const;
   bool isCart1Inactive() const;
 
+  //EEPROM is not in the middle of a command. GameDrive works with host files and is not part of the state
+  bool snapshotReady() const;
+  void serialize( Snapshot & snapshot );
+  //adds coroutine resumes of EEPROM and GameDrive
+  void addPerfCounters( PerfCounters & counters ) const;
+
 private:
   uint8_t peek( CartBank const& bank );
+  void selectBanks();
 
   void incrementCounter( uint64_t tick );
 
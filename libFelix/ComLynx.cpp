@@ -3,6 +3,7 @@
 #include "Utility.hpp"
 #include "ComLynxWire.hpp"
 #include "Log.hpp"
+#include "Snapshot.hpp"
 
 ComLynx::ComLynx( std::shared_ptr<ComLynxWire> comLynxWire ) : mId{ comLynxWire->connect() }, mTx{ mId, comLynxWire }, mRx{ mId, comLynxWire }
 {
@@ -76,6 +77,13 @@ bool ComLynx::present() const
   return true;
 }
 
+void ComLynx::serialize( Snapshot & snapshot )
+{
+  snapshot.section( "CLNX" );
+  mTx.serialize( snapshot );
+  mRx.serialize( snapshot );
+}
+
 ComLynx::Transmitter::Transmitter( int id, std::shared_ptr<ComLynxWire> comLynxWire ) : mWire{ std::move( comLynxWire ) }, mData{}, mState{ 1 }, mCounter{}, mParity{}, mShifter{}, mParEn{}, mIntEn{}, mTxBrk{}, mParBit{}, mId{ id }
 {
 }
@@ -93,7 +101,7 @@ void ComLynx::Transmitter::setCtrl( uint8_t ctrl )
 void ComLynx::Transmitter::setData( int data )
 {
   mData = data;
-  L_DEBUG << "Tx" << mId << ": SetData=" << std::hex << std::setw( 2 ) << std::setfill( '0' ) << mData.value();
+  L_DEBUG << "Tx" << mId << ": SetData=" << fmt::format( "{:02x}", mData.value() );
 }
 
 uint8_t ComLynx::Transmitter::getStatus() const
@@ -113,9 +121,10 @@ void ComLynx::Transmitter::process()
   switch ( mCounter )
   {
   case 1:
-    pull( 1 );
     mParity = std::popcount( mShifter ) & 1;
+    //data must be published before the stop bit so that a receiver on another thread reads it
     mWire->setCoarse( mShifter, mParEn ? mParity : mParBit );
+    pull( 1 );
     mCounter = 0;
     L_DEBUG << "Tx" << mId << ": Stop";
     break;
@@ -132,7 +141,7 @@ void ComLynx::Transmitter::process()
       mData.reset();
       mCounter = 10;
       mParity = 0;
-      L_INFO << "Tx" << mId << ": Start Data=" << std::hex << std::setw( 2 ) << std::setfill( '0' ) << mShifter;
+      L_INFO << "Tx" << mId << ": Start Data=" << fmt::format( "{:02x}", mShifter );
     }
     break;
   default:
@@ -141,6 +150,16 @@ void ComLynx::Transmitter::process()
   }
 }
 
+void ComLynx::Transmitter::serialize( Snapshot & snapshot )
+{
+  int state = mState;
+  snapshot( mData, state, mCounter, mParity, mShifter, mParEn, mIntEn, mTxBrk, mParBit );
+
+  //wire level is adjusted by the difference of restored pull
+  if ( snapshot.loading() )
+    pull( state );
+}
+
 void ComLynx::Transmitter::pull( int bit )
 {
   if ( mState != bit )
@@ -180,7 +199,7 @@ int ComLynx::Receiver::getData()
 {
   if ( mData.has_value() )
   {
-    L_DEBUG << "Rx" << mId << ": GetData=" << std::hex << std::setw( 2 ) << std::setfill( '0' ) << mData.value();
+    L_DEBUG << "Rx" << mId << ": GetData=" << fmt::format( "{:02x}", mData.value() );
     int result = mData.value_or( 0 );
     mData.reset();
     return result;
@@ -233,7 +252,7 @@ void ComLynx::Receiver::process()
         bool overrun = mData.has_value();
         mOverrun |= overrun ? SERCTL::OVERRUN : 0;
         mData = mWire->getCoarse( mParity );
-        L_TRACE << "Rx" << mId << ": Stop Data=" << std::hex << std::setw( 2 ) << std::setfill( '0' ) << *mData << ( overrun ? " overrun" : "" );
+        L_TRACE << "Rx" << mId << ": Stop Data=" << fmt::format( "{:02x}", *mData ) << ( overrun ? " overrun" : "" );
       }
       mCounter = 0;
       break;
@@ -253,3 +272,8 @@ void ComLynx::Receiver::process()
     }
   }
 }
+
+void ComLynx::Receiver::serialize( Snapshot & snapshot )
+{
+  snapshot( mData, mCounter, mParity, mParErr, mFrameErr, mRxBrk, mOverrun, mIntEn );
+}
@@ -1,10 +1,11 @@
 #pragma once
 
 
-//It's a relic of two instance of emulation in one process that was communicating using coarse algorithm through ComLynxWire.
-//It needs to be rewritten to multiple processes
+//Instances communicate using coarse algorithm through shared ComLynxWire.
+//Multiple instances in one process can be run in parallel by ComLynxNetwork.
 
 class ComLynxWire;
+class Snapshot;
 
 class ComLynx
 {
@@ -22,6 +23,9 @@ public:
 
   bool interrupt() const;
 
+  //the shared wire is not part of the state, only this instance's pull on it
+  void serialize( Snapshot & snapshot );
+
 private:
 
   struct SERCTL
@@ -58,6 +62,7 @@ private:
     uint8_t getStatus() const;
     bool interrupt() const;
     void process();
+    void serialize( Snapshot & snapshot );
 
   private:
 
@@ -86,6 +91,7 @@ private:
     uint8_t getStatus() const;
     bool interrupt() const;
     void process();
+    void serialize( Snapshot & snapshot );
 
   private:
     std::shared_ptr<ComLynxWire> mWire;
@@ -0,0 +1,139 @@
+#include "pch.hpp"
+#include "ComLynxNetwork.hpp"
+#include "ComLynxWire.hpp"
+#include "Core.hpp"
+#include "Log.hpp"
+
+ComLynxNetwork::ComLynxNetwork( std::vector<std::shared_ptr<Core>> cores, std::shared_ptr<ComLynxWire> wire, uint64_t busyQuantum, uint64_t idleQuantum ) :
+  mCores{ std::move( cores ) }, mWire{ std::move( wire ) }, mBusyQuantum{ std::max( busyQuantum, uint64_t{ 1 } ) }, mIdleQuantum{ std::max( idleQuantum, mBusyQuantum ) },
+  mBaseTicks{}, mEnd{}, mEpochEnd{}, mQuantum{ mBusyQuantum }, mLastTransitions{}, mDone{}, mBrokenCore{ -1 }, mException{}, mBreakType{ CpuBreakType::NONE }, mStats{}
+{
+  assert( mWire );
+  if ( mWire->clients() != (int)mCores.size() )
+  {
+    L_WARNING << "ComLynxNetwork: " << mCores.size() << " cores on a wire with " << mWire->clients() << " clients";
+  }
+}
+
+ComLynxNetwork::~ComLynxNetwork()
+{
+}
+
+CpuBreakType ComLynxNetwork::run( uint64_t ticks )
+{
+  if ( mCores.empty() || ticks == 0 )
+    return CpuBreakType::NONE;
+
+  mBaseTicks.clear();
+  for ( auto const& core : mCores )
+  {
+    mBaseTicks.push_back( core->tick() );
+  }
+
+  mEnd = ticks;
+  mQuantum = mBusyQuantum;
+  mEpochEnd = std::min( mQuantum, mEnd );
+  mLastTransitions = mWire->transitions();
+  mDone = false;
+  mBrokenCore.store( -1 );
+  mException = nullptr;
+  mBreakType = CpuBreakType::NONE;
+
+  std::barrier<Completion> barrier{ (std::ptrdiff_t)mCores.size(), Completion{ this } };
+
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve( mCores.size() );
+    for ( size_t i = 0; i < mCores.size(); ++i )
+    {
+      workers.emplace_back( [this, i, &barrier]
+      {
+        worker( i, barrier );
+      } );
+    }
+  }
+
+  if ( mException )
+    std::rethrow_exception( std::exchange( mException, nullptr ) );
+
+  return mBreakType;
+}
+
+void ComLynxNetwork::worker( size_t index, std::barrier<Completion> & barrier )
+{
+  auto & core = *mCores[index];
+
+  //mDone and mEpochEnd are written only by the completion step, the barrier orders them with respect to workers
+  while ( !mDone )
+  {
+    //a failing core still arrives at the barrier so that the others are not left waiting for it
+    try
+    {
+      auto cpuBreakType = core.runUntil( mBaseTicks[index] + mEpochEnd );
+      if ( cpuBreakType != CpuBreakType::NONE )
+      {
+        int expected = -1;
+        if ( mBrokenCore.compare_exchange_strong( expected, (int)index ) )
+        {
+          mBreakType = cpuBreakType;
+        }
+      }
+    }
+    catch ( ... )
+    {
+      int expected = -1;
+      if ( mBrokenCore.compare_exchange_strong( expected, (int)index ) )
+      {
+        mException = std::current_exception();
+      }
+    }
+    barrier.arrive_and_wait();
+  }
+}
+
+void ComLynxNetwork::Completion::operator()() noexcept
+{
+  network->nextEpoch();
+}
+
+void ComLynxNetwork::nextEpoch()
+{
+  mStats.barriers += 1;
+
+  if ( mBrokenCore.load() >= 0 || mEpochEnd >= mEnd )
+  {
+    mStats.ticks += mEpochEnd;
+    mDone = true;
+    return;
+  }
+
+  auto transitions = mWire->transitions();
+  if ( mWire->busy() || transitions != mLastTransitions )
+  {
+    mQuantum = mBusyQuantum;
+    mStats.busyBarriers += 1;
+  }
+  else
+  {
+    mQuantum = std::min( mQuantum * 2, mIdleQuantum );
+  }
+  mLastTransitions = transitions;
+
+  mEpochEnd = std::min( mEpochEnd + mQuantum, mEnd );
+}
+
+std::optional<size_t> ComLynxNetwork::brokenCore() const
+{
+  int broken = mBrokenCore.load();
+  return broken < 0 ? std::nullopt : std::optional<size_t>{ (size_t)broken };
+}
+
+ComLynxNetwork::Stats ComLynxNetwork::stats() const
+{
+  return mStats;
+}
+
+size_t ComLynxNetwork::size() const
+{
+  return mCores.size();
+}
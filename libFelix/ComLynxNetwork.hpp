@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Utility.hpp"
+
+class Core;
+class ComLynxWire;
+
+//Runs several Cores connected through one ComLynxWire, each on its own thread.
+//Cores are kept within one quantum of emulated time from each other by a barrier.
+//The quantum is short while the wire is active and grows while it stays idle.
+class ComLynxNetwork : public NonCopyable
+{
+public:
+  //shorter than one bit at the fastest baud rate
+  static constexpr uint64_t BUSY_QUANTUM = 64;
+  static constexpr uint64_t IDLE_QUANTUM = 16384;
+
+  struct Stats
+  {
+    uint64_t barriers;
+    uint64_t busyBarriers;
+    uint64_t ticks;
+  };
+
+  ComLynxNetwork( std::vector<std::shared_ptr<Core>> cores, std::shared_ptr<ComLynxWire> wire, uint64_t busyQuantum = BUSY_QUANTUM, uint64_t idleQuantum = IDLE_QUANTUM );
+  ~ComLynxNetwork();
+
+  //advances all cores by given number of ticks or until any of them breaks. Rethrows exception thrown by any core
+  CpuBreakType run( uint64_t ticks );
+
+  //index of the core that caused last run to return early
+  std::optional<size_t> brokenCore() const;
+  Stats stats() const;
+  size_t size() const;
+
+private:
+  struct Completion
+  {
+    ComLynxNetwork* network;
+    void operator()() noexcept;
+  };
+
+  void worker( size_t index, std::barrier<Completion> & barrier );
+  void nextEpoch();
+
+private:
+  std::vector<std::shared_ptr<Core>> mCores;
+  std::shared_ptr<ComLynxWire> mWire;
+  uint64_t const mBusyQuantum;
+  uint64_t const mIdleQuantum;
+  std::vector<uint64_t> mBaseTicks;
+  uint64_t mEnd;
+  uint64_t mEpochEnd;
+  uint64_t mQuantum;
+  uint64_t mLastTransitions;
+  bool mDone;
+  std::atomic<int> mBrokenCore;
+  //written only by the worker that set mBrokenCore
+  std::exception_ptr mException;
+  CpuBreakType mBreakType;
+  Stats mStats;
+};
@@ -1,51 +1,72 @@
 #pragma once
 
+//Shared between all connected ComLynx instances that can run on separate threads (see ComLynxNetwork)
 class ComLynxWire
 {
 public:
-  ComLynxWire() : mValue{ 0 }, mClients{ 0 }, mCoarseValue{}, mParBit{} {}
+  ComLynxWire() : mValue{ 0 }, mClients{ 0 }, mCoarse{}, mTransitions{} {}
 
   void pullUp()
   {
-    mValue += 1;
+    mValue.fetch_add( 1, std::memory_order_acq_rel );
+    mTransitions.fetch_add( 1, std::memory_order_relaxed );
   }
 
   void pullDown()
   {
-    mValue -= 1;
+    mValue.fetch_sub( 1, std::memory_order_acq_rel );
+    mTransitions.fetch_add( 1, std::memory_order_relaxed );
   }
 
   int wire() const
   {
-    return mValue;
+    return mValue.load( std::memory_order_acquire );
   }
 
   int value() const
   {
-    return mValue == 0 ? 1 : 0;
+    return wire() == 0 ? 1 : 0;
   }
 
   int connect()
   {
-    return mClients++;
+    return mClients.fetch_add( 1, std::memory_order_relaxed );
   }
 
+  int clients() const
+  {
+    return mClients.load( std::memory_order_relaxed );
+  }
+
+  //value and parity bit are published together so that a receiver on another thread never sees a torn pair
   void setCoarse( int value, int parbit )
   {
-    mCoarseValue = value;
-    mParBit = parbit;
+    mCoarse.store( ( value & 0xffff ) | ( ( parbit & 1 ) << 16 ), std::memory_order_release );
   }
 
   int getCoarse( int & parbit ) const
   {
-    return mCoarseValue;
-    parbit = mParBit;
+    int coarse = mCoarse.load( std::memory_order_acquire );
+    parbit = ( coarse >> 16 ) & 1;
+    return coarse & 0xffff;
+  }
+
+  //any transmitter is holding the line low, i.e. a byte is in flight or a break is sent
+  bool busy() const
+  {
+    return wire() != 0;
+  }
+
+  //monotonic count of line level changes
+  uint64_t transitions() const
+  {
+    return mTransitions.load( std::memory_order_relaxed );
   }
 
 private:
   //value is pulled up in idle (0) state.
-  int mValue;
-  int mClients;
-  int mCoarseValue;
-  int mParBit;
+  std::atomic<int> mValue;
+  std::atomic<int> mClients;
+  std::atomic<int> mCoarse;
+  std::atomic<uint64_t> mTransitions;
 };
@@ -15,21 +15,55 @@
 #include "DebugRAM.hpp"
 #include "ScriptDebuggerEscapes.hpp"
 #include "VGMWriter.hpp"
+#include "Snapshot.hpp"
+#include "CpuTrace.hpp"
+#include "Profiler.hpp"
+#include "Coverage.hpp"
+#include "WriteMonitor.hpp"
+#include "RamFreeze.hpp"
+#include "DebugView.hpp"
 
 uint8_t* gDebugRAM;
 
 static constexpr uint64_t RESET_DURATION = 5 * 10;  //asserting RESET for 10 cycles to make sure none will miss it
 static constexpr uint32_t BAD_LAST_ACCESS_PAGE = ~0;
 
+namespace
+{
+
+uint64_t hashBytes( std::span<uint8_t const> data )
+{
+  static constexpr uint64_t PRIME = 0x100000001b3ull;
+  uint64_t hash = 0xcbf29ce484222325ull;
+
+  size_t i = 0;
+  for ( ; i + sizeof( uint64_t ) <= data.size(); i += sizeof( uint64_t ) )
+  {
+    uint64_t word;
+    std::memcpy( &word, data.data() + i, sizeof( word ) );
+    hash = ( hash ^ word ) * PRIME;
+    //multiplication carries differences only upwards
+    hash ^= hash >> 29;
+  }
+  for ( ; i < data.size(); ++i )
+  {
+    hash = ( hash ^ data[i] ) * PRIME;
+  }
+
+  return hash;
+}
+
+}
+
 static constexpr bool ENABLE_TRAPS = true;
 
 Core::Core( ImageProperties const& imageProperties, std::shared_ptr<ComLynxWire> comLynxWire, std::shared_ptr<IVideoSink> videoSink,
   std::shared_ptr<IInputSource> inputSource, InputFile inputFile, std::shared_ptr<ImageROM const> bootROM,
-  std::shared_ptr<ScriptDebuggerEscapes> scriptDebuggerEscapes ) :
-  mRAM{}, mROM{}, mPageTypes{}, mScriptDebugger{ std::make_shared<ScriptDebugger>() }, mCurrentTick{}, mSamplesRemainder{}, mActionQueue{}, mTraceHelper{ std::make_shared<TraceHelper>() }, mCpu{ std::make_shared<CPU>( mTraceHelper ) },
+  std::shared_ptr<ScriptDebuggerEscapes> scriptDebuggerEscapes, uint64_t seed ) :
+  mRAM{}, mROM{}, mPageTypes{}, mSeed{ seed }, mScriptDebugger{ std::make_shared<ScriptDebugger>() }, mCurrentTick{}, mSamplesRemainder{}, mActionQueue{}, mTraceHelper{ std::make_shared<TraceHelper>() }, mCpu{ std::make_shared<CPU>( mTraceHelper, seed ) },
   mCartridge{ std::make_shared<Cartridge>( imageProperties, std::shared_ptr<ImageCart>{}, mTraceHelper ) }, mComLynx{ std::make_shared<ComLynx>( comLynxWire ) }, mComLynxWire{ comLynxWire },
-  mMikey{ std::make_shared<Mikey>( *this, *mComLynx, videoSink ) }, mSuzy{ std::make_shared<Suzy>( *this, inputSource ) }, mMapCtl{}, mLastAccessPage{ BAD_LAST_ACCESS_PAGE },
-  mDMAAddress{}, mFastCycleTick{ 4 }, mPatchMagickCodeAccumulator{}, mResetRequestDuringSpriteRendering{}, mSuzyRunning{}, mGlobalSamplesEmitted{}, mGlobalSamplesEmittedSnapshot{}, mGlobalSamplesEmittedPerFrame{}
+  mMikey{ std::make_shared<Mikey>( *this, *mComLynx, videoSink ) }, mSuzy{ std::make_shared<Suzy>( *this, inputSource, seed ) }, mInputSource{ inputSource }, mMapCtl{}, mLastAccessPage{ BAD_LAST_ACCESS_PAGE },
+  mDMAAddress{}, mFastCycleTick{ 4 }, mPatchMagickCodeAccumulator{}, mResetRequestDuringSpriteRendering{}, mSuzyRunning{}, mGlobalSamplesEmitted{}, mGlobalSamplesEmittedSnapshot{}, mGlobalSamplesEmittedPerFrame{}, mFrameCount{}, mFrameBreak{}, mVideoMuted{}, mInputPerScanline{}, mStateHashScratch{}, mProfiler{}, mCoverage{}, mFrameCallback{}, mWriteMonitor{ std::make_shared<WriteMonitor>() }, mRamFreeze{ std::make_shared<RamFreeze>() }, mPerfCounters{}
 {
   gDebugRAM = &mRAM[0];
 
@@ -103,9 +137,13 @@ void Core::setROM( std::shared_ptr<ImageROM const> bootROM )
   setBootROMTraps( mTraceHelper, *mScriptDebugger );
 }
 
-void Core::setLog( std::filesystem::path const & path )
+void Core::setLog( std::filesystem::path const & path, CpuTraceFilter const& filter )
 {
-  mCpu->setLog( path );
+  auto writer = std::make_unique<CpuTraceWriter>( path, filter, mCurrentTick );
+  if ( writer->good() )
+    mCpu->setLog( std::move( writer ) );
+  else
+    L_WARNING << "Can't write trace to " << path.string();
 }
 
 void Core::setVGMWriter( std::shared_ptr<VGMWriter> writer )
@@ -115,6 +153,43 @@ void Core::setVGMWriter( std::shared_ptr<VGMWriter> writer )
   mMikey->setVGMWriter( std::move( writer ) );
 }
 
+std::shared_ptr<Profiler> Core::enableProfiler()
+{
+  mProfiler = std::make_shared<Profiler>( mCurrentTick );
+  mCpu->setProfiler( mProfiler.get() );
+  return mProfiler;
+}
+
+std::shared_ptr<Coverage> Core::enableCoverage()
+{
+  mCoverage = std::make_shared<Coverage>();
+  return mCoverage;
+}
+
+void Core::setFrameCallback( std::function<void( uint64_t )> callback )
+{
+  mFrameCallback = std::move( callback );
+}
+
+std::shared_ptr<WriteMonitor> Core::writeMonitor() const
+{
+  return mWriteMonitor;
+}
+
+std::shared_ptr<RamFreeze> Core::ramFreeze() const
+{
+  return mRamFreeze;
+}
+
+PerfCounters Core::perfCounters() const
+{
+  auto result = mPerfCounters;
+  result.pushes = mActionQueue.pushes();
+  result.pops = mActionQueue.pops();
+  mCartridge->addPerfCounters( result );
+  return result;
+}
+
 void Core::pulseReset( std::optional<uint16_t> resetAddress )
 {
   if ( resetAddress )
@@ -198,10 +273,14 @@ void Core::executeSequencedAction( SequencedAction seqAction )
 {
   auto action = seqAction.getAction();
 
+  auto subsystem = action == Action::DISPLAY_DMA ? PerfCounters::Subsystem::DISPLAY : action == Action::SAMPLE_AUDIO ? PerfCounters::Subsystem::AUDIO : PerfCounters::Subsystem::MIKEY;
+  PerfTimer timer{ mPerfCounters.nanoseconds[(size_t)subsystem] };
+
   switch ( action )
   {
   case Action::DISPLAY_DMA:
     mMikey->setDMAData( mCurrentTick, *(uint64_t *)( mRAM.data() + mDMAAddress ) );
+    perfCount( mPerfCounters.displayDmaBursts );
     mCurrentTick += 6 * mFastCycleTick + 2 * 5;
     break;
   case Action::FIRE_TIMER0:
@@ -243,6 +322,7 @@ void Core::executeSequencedAction( SequencedAction seqAction )
     {
       mOutputSamples[mSamplesEmitted++] = mMikey->sampleAudio( mCurrentTick );
       mGlobalSamplesEmitted += 1;
+      perfCount( mPerfCounters.audioSamples );
       enqueueSampling();
     }
     break;
@@ -269,7 +349,46 @@ bool Core::executeSuzyAction()
     return false;
   }
 
+  PerfTimer timer{ mPerfCounters.nanoseconds[(size_t)PerfCounters::Subsystem::SUZY] };
+
   mSuzyProcessRequest = mSuzyProcess->advance();
+  perfCount( mPerfCounters.resumes[(size_t)PerfCounters::Coroutine::SUZY] );
+  perfCount( mPerfCounters.suzyRequests[mSuzyProcessRequest->type] );
+
+  if ( mCoverage )
+  {
+    auto const& req = *mSuzyProcessRequest;
+    switch ( req.type )
+    {
+    case ISuzyProcess::Request::READ:
+    case ISuzyProcess::Request::FETCHSCB:
+      mCoverage->read( req.addr );
+      break;
+    case ISuzyProcess::Request::READ4:
+    case ISuzyProcess::Request::READPAL:
+      for ( uint32_t i = 0; i < 4 && req.addr + i < Coverage::ROM; ++i )
+        mCoverage->read( req.addr + i );
+      break;
+    case ISuzyProcess::Request::WRITE:
+    case ISuzyProcess::Request::WRITEFRED:
+      mCoverage->write( req.addr );
+      break;
+    case ISuzyProcess::Request::COLRMW:
+      for ( uint32_t i = 0; i < 4 && req.addr + i < Coverage::ROM; ++i )
+      {
+        mCoverage->read( req.addr + i );
+        mCoverage->write( req.addr + i );
+      }
+      break;
+    case ISuzyProcess::Request::VIDRMW:
+    case ISuzyProcess::Request::XOR:
+      mCoverage->read( req.addr );
+      mCoverage->write( req.addr );
+      break;
+    default:
+      break;
+    }
+  }
 
   switch ( mSuzyProcessRequest->type )
   {
@@ -298,6 +417,7 @@ bool Core::executeSuzyAction()
   case ISuzyProcess::Request::WRITE:
   case ISuzyProcess::Request::WRITEFRED:
     mRAM[mSuzyProcessRequest->addr] = (uint8_t)mSuzyProcessRequest->value;
+    suzyWritten( mSuzyProcessRequest->addr, 1 );
     mCurrentTick += 5ull; //write byte
     break;
   case ISuzyProcess::Request::COLRMW:
@@ -314,6 +434,7 @@ bool Core::executeSuzyAction()
       const uint32_t outValue = value & mSuzyProcessRequest->mask;
 
       *( (uint32_t *)( mRAM.data() + mSuzyProcessRequest->addr ) ) = maskedValue | maskedU32;
+      suzyWritten( mSuzyProcessRequest->addr, 4 );
 
       mSuzyProcess->respond( outValue );
     }
@@ -323,6 +444,7 @@ bool Core::executeSuzyAction()
     {
       auto value = mRAM[mSuzyProcessRequest->addr] & mSuzyProcessRequest->mask | mSuzyProcessRequest->value;
       mRAM[mSuzyProcessRequest->addr] = (uint8_t)value;
+      suzyWritten( mSuzyProcessRequest->addr, 1 );
     }
     mCurrentTick += 5ull + mFastCycleTick;  //read & write byte
     break;
@@ -331,6 +453,7 @@ bool Core::executeSuzyAction()
       auto ramValue = mRAM[mSuzyProcessRequest->addr];
       auto xorValue = ramValue ^ mSuzyProcessRequest->value;
       mRAM[mSuzyProcessRequest->addr] = (uint8_t)xorValue;
+      suzyWritten( mSuzyProcessRequest->addr, 1 );
     }
     mCurrentTick += 5ull + mFastCycleTick; //read & write byte
     break;
@@ -341,10 +464,56 @@ bool Core::executeSuzyAction()
 
 CpuBreakType Core::executeCPUAction()
 {
+  PerfTimer timer{ mPerfCounters.nanoseconds[(size_t)PerfCounters::Subsystem::CPU] };
+
   auto const& req = mCpu->advance();
 
   auto pageType = mPageTypes[req.address >> 8];
 
+  if constexpr ( ENABLE_PERF_COUNTERS )
+  {
+    mPerfCounters.resumes[(size_t)PerfCounters::Coroutine::CPU] += 1;
+    mPerfCounters.busCycles[(size_t)pageType / 4] += 1;
+    if ( req.type == CPU::Request::Type::FETCH_OPCODE )
+      mPerfCounters.instructions += 1;
+  }
+
+  if ( mCoverage )
+  {
+    uint32_t cell;
+    switch ( pageType )
+    {
+    case PageType::SUZY:
+      cell = Coverage::SUZY + ( req.address & 0xff );
+      break;
+    case PageType::MIKEY:
+      cell = Coverage::MIKEY + ( req.address & 0xff );
+      break;
+    case PageType::ROM:
+      cell = Coverage::ROM + ( req.address & 0x1ff );
+      break;
+    default:
+      cell = Coverage::RAM + req.address;
+      break;
+    }
+
+    switch ( req.type )
+    {
+    case CPU::Request::Type::READ:
+      mCoverage->read( cell );
+      break;
+    case CPU::Request::Type::WRITE:
+      mCoverage->write( cell );
+      break;
+    case CPU::Request::Type::FETCH_OPCODE:
+      mCoverage->executeOpcode( cell );
+      break;
+    default:
+      mCoverage->execute( cell );
+      break;
+    }
+  }
+
   enum class CPUAction
   {
     FETCH_OPCODE_RAM = 0,
@@ -482,6 +651,173 @@ CpuBreakType Core::run( RunMode runMode )
   }
 }
 
+CpuBreakType Core::runUntil( uint64_t tick )
+{
+  if ( mCurrentTick >= tick )
+    return CpuBreakType::NONE;
+
+  mActionQueue.push( { Action::BATCH_END, tick } );
+  auto cpuBreakType = run( RunMode::RUN );
+  mActionQueue.erase( Action::BATCH_END );
+
+  return cpuBreakType == CpuBreakType::NEXT ? CpuBreakType::NONE : cpuBreakType;
+}
+
+CpuBreakType Core::runFrames( uint64_t count )
+{
+  //bound in case the display timers are stopped
+  static constexpr uint64_t MAX_FRAME_TICKS = 16000000 / 30;
+
+  mFrameBreak = mFrameCount + count;
+  auto cpuBreakType = runUntil( mCurrentTick + count * MAX_FRAME_TICKS );
+  mFrameBreak = 0;
+
+  return cpuBreakType;
+}
+
+bool Core::snapshotReady() const
+{
+  return mCpu->atInstructionBoundary() && !mSuzyProcess && mCartridge->snapshotReady();
+}
+
+CpuBreakType Core::runToSnapshotBoundary( uint64_t maxTicks )
+{
+  uint64_t const end = mCurrentTick + maxTicks;
+
+  while ( !snapshotReady() && mCurrentTick < end )
+  {
+    //each step ends on the first instruction boundary
+    auto cpuBreakType = runUntil( mCurrentTick + 1 );
+    if ( cpuBreakType != CpuBreakType::NONE )
+      return cpuBreakType;
+  }
+
+  return CpuBreakType::NONE;
+}
+
+bool Core::snapshot( std::vector<uint8_t> & out )
+{
+  if ( !snapshotReady() )
+    return false;
+
+  Snapshot snapshot{ out };
+  serialize( snapshot );
+  return true;
+}
+
+bool Core::restore( std::span<uint8_t const> data )
+{
+  //machine is left as is if any section is truncated or mismatched
+  {
+    Snapshot verification{ data, true };
+    serialize( verification );
+    if ( !verification.good() )
+      return false;
+  }
+
+  Snapshot snapshot{ data };
+  serialize( snapshot );
+  if ( mWriteMonitor )
+    mWriteMonitor->invalidate();
+  mRamFreeze->invalidate();
+  return snapshot.good();
+}
+
+void Core::muteVideo( bool muted )
+{
+  mVideoMuted = muted;
+  mMikey->muteVideo( muted );
+}
+
+Core::StateHash Core::stateHash()
+{
+  StateHash result{ mCurrentTick };
+  result.ram = hashBytes( mRAM );
+
+  //registers are hashed in serialized form, so that the hash covers exactly what a snapshot would
+  {
+    Snapshot snapshot{ mStateHashScratch };
+    mCpu->serialize( snapshot );
+  }
+  result.cpu = hashBytes( mStateHashScratch );
+  {
+    Snapshot snapshot{ mStateHashScratch };
+    mMikey->serialize( snapshot );
+  }
+  result.mikey = hashBytes( mStateHashScratch );
+  {
+    Snapshot snapshot{ mStateHashScratch };
+    mSuzy->serialize( snapshot );
+  }
+  result.suzy = hashBytes( mStateHashScratch );
+
+  return result;
+}
+
+void Core::latchInputPerScanline( bool value )
+{
+  mInputPerScanline = value;
+}
+
+bool Core::runAhead( int frames, std::vector<uint8_t> & state )
+{
+  assert( frames > 0 );
+
+  if ( !snapshot( state ) )
+    return false;
+
+  bool videoMuted = mVideoMuted;
+  uint64_t frameCount = mFrameCount;
+  auto vgmWriter = mMikey->vgmWriter();
+  mMikey->setVGMWriter( {} );
+  auto profiler = std::move( mProfiler );
+  mCpu->setProfiler( nullptr );
+  auto coverage = std::move( mCoverage );
+  auto frameCallback = std::move( mFrameCallback );
+  mFrameCallback = {};
+  //speculative writes are not observed
+  auto writeMonitor = std::move( mWriteMonitor );
+
+  muteVideo( true );
+  runFrames( frames );
+  muteVideo( false );
+  runFrames( 1 );
+  muteVideo( videoMuted );
+
+  mMikey->setVGMWriter( std::move( vgmWriter ) );
+  bool result = restore( state );
+  mProfiler = std::move( profiler );
+  mCpu->setProfiler( mProfiler.get() );
+  mCoverage = std::move( coverage );
+  mFrameCallback = std::move( frameCallback );
+  mWriteMonitor = std::move( writeMonitor );
+  //speculative frames do not count
+  mFrameCount = frameCount;
+  return result;
+}
+
+void Core::serialize( Snapshot & snapshot )
+{
+  snapshot.section( "CORE" );
+  snapshot( mRAM, mPageTypes, mCurrentTick, mSamplesRemainder, mGlobalSamplesEmitted, mGlobalSamplesEmittedSnapshot, mGlobalSamplesEmittedPerFrame,
+    mMapCtl, mFastCycleTick, mPatchMagickCodeAccumulator, mLastAccessPage, mDMAAddress, mResetRequestDuringSpriteRendering );
+
+  mActionQueue.serialize( snapshot );
+  mCpu->serialize( snapshot );
+  mMikey->serialize( snapshot );
+  mSuzy->serialize( snapshot );
+  mComLynx->serialize( snapshot );
+  mCartridge->serialize( snapshot );
+
+  if ( snapshot.loading() )
+  {
+    //snapshot is taken only while Suzy is idle
+    mSuzyProcess.reset();
+    mSuzyProcessRequest = nullptr;
+    mSuzyRunning = false;
+  }
+}
+
 CpuBreakType Core::advanceAudio( int sps, std::span<AudioSample> outputBuffer, RunMode runMode )
 {
   mSPS = sps;
@@ -534,6 +870,31 @@ void Core::newLine( int rowNr )
     mGlobalSamplesEmittedPerFrame = mGlobalSamplesEmitted - mGlobalSamplesEmittedSnapshot;
     mGlobalSamplesEmittedSnapshot = mGlobalSamplesEmitted;
   }
+  else if ( rowNr == 104 )
+  {
+    //Mikey starts new frame in the video sink on this row
+    mFrameCount += 1;
+    mInputSource->newFrame( mFrameCount, mCurrentTick );
+    if ( mProfiler )
+      mProfiler->newFrame( mFrameCount );
+    if ( mCoverage )
+      mCoverage->newFrame( mFrameCount );
+    if ( mFrameCallback )
+      mFrameCallback( mFrameCount );
+    if ( mFrameCount == mFrameBreak )
+      mCpu->breakNext();
+  }
+
+  if ( mInputPerScanline || rowNr == 104 )
+    mSuzy->latchInput( mCurrentTick );
+
+  if ( mRamFreeze->takePending() )
+  {
+    for ( auto [address, value] : mRamFreeze->freezes() )
+    {
+      debugWriteRAM( address, value );
+    }
+  }
 }
 
 std::shared_ptr<TraceHelper> Core::getTraceHelper() const
@@ -639,11 +1000,25 @@ void Core::writeRAM( uint16_t address, uint8_t value )
   if constexpr ( ENABLE_TRAPS )
   {
     uint8_t filteredByte = mScriptDebugger->writeRAM( *this, address, value );
-    mRAM[address] = filteredByte;
+    mRAM[address] = mRamFreeze->write( address, filteredByte );
   }
   else
   {
-    mRAM[address] = value;
+    mRAM[address] = mRamFreeze->write( address, value );
+  }
+
+  if ( mWriteMonitor )
+    mWriteMonitor->write( address, mRAM[address], mCurrentTick, mCpu->instructionPC(), WriteMonitor::Source::CPU );
+}
+
+void Core::suzyWritten( uint16_t address, int size )
+{
+  for ( int i = 0; i < size; ++i )
+  {
+    auto & byte = mRAM[(uint16_t)( address + i )];
+    byte = mRamFreeze->write( (uint16_t)( address + i ), byte );
+    if ( mWriteMonitor )
+      mWriteMonitor->write( (uint16_t)( address + i ), byte, mCurrentTick, mCpu->instructionPC(), WriteMonitor::Source::SUZY );
   }
 }
 
@@ -788,6 +1163,16 @@ uint64_t Core::tick() const
   return mCurrentTick;
 }
 
+uint64_t Core::seed() const
+{
+  return mSeed;
+}
+
+uint64_t Core::frameCount() const
+{
+  return mFrameCount;
+}
+
 uint8_t Core::debugReadRAM( uint16_t address ) const
 {
   return mRAM[address];
@@ -801,6 +1186,8 @@ uint8_t Core::debugReadROM( uint16_t address ) const
 void Core::debugWriteRAM( uint16_t address, uint8_t value )
 {
   mRAM[address] = value;
+  if ( mWriteMonitor )
+    mWriteMonitor->write( address, value, mCurrentTick, mCpu->instructionPC(), WriteMonitor::Source::DEBUGGER );
 }
 
 uint8_t Core::debugReadMikey( uint16_t address ) const
@@ -865,3 +1252,24 @@ std::span<uint8_t const, 32> Core::debugPalette() const
   return mMikey->debugPalette();
 }
 
+void Core::debugCapture( DebugView & view ) const
+{
+  std::copy( mRAM.cbegin(), mRAM.cend(), view.ram.begin() );
+  std::copy_n( mRAM.cbegin(), DebugView::SCREEN_SIZE, view.ram.begin() + mRAM.size() );
+  view.cpu = mCpu->state();
+  auto palette = mMikey->debugPalette();
+  std::copy( palette.begin(), palette.end(), view.palette.begin() );
+  view.dispAdr = mMikey->debugDispAdr();
+  view.vidBas = mSuzy->debugVidBas();
+  view.collBas = mSuzy->debugCollBas();
+  view.tick = mCurrentTick;
+  if ( mCoverage )
+    std::ranges::copy( mCoverage->opcodes(), view.opcodes.begin() );
+  else
+    view.opcodes.fill( 0 );
+  view.writeMonitor = mWriteMonitor.get();
+  view.writeSequence = mWriteMonitor->sequence();
+  if constexpr ( ENABLE_PERF_COUNTERS )
+    view.perf = perfCounters();
+}
+
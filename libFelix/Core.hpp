@@ -2,6 +2,7 @@
 
 #include "IVideoSink.hpp"
 #include "ActionQueue.hpp"
+#include "PerfCounters.hpp"
 #include "DisplayGenerator.hpp"
 #include "Suzy.hpp"
 #include "Utility.hpp"
@@ -21,26 +22,88 @@ class TraceHelper;
 class ScriptDebuggerEscapes;
 class ScriptDebugger;
 class VGMWriter;
+class Snapshot;
 struct CPUState;
+struct CpuTraceFilter;
+class Profiler;
+class Coverage;
+class WriteMonitor;
+class RamFreeze;
+struct DebugView;
 
 class Core
 {
 public:
+  //seed determines undefined power-on state, so that runs with the same seed and input are identical
   Core( ImageProperties const& imageProperties, std::shared_ptr<ComLynxWire> comLynxWire, std::shared_ptr<IVideoSink> videoSink,
     std::shared_ptr<IInputSource> inputSource, InputFile inputFile, std::shared_ptr<ImageROM const> bios,
-    std::shared_ptr<ScriptDebuggerEscapes> scriptDebuggerEscapes );
+    std::shared_ptr<ScriptDebuggerEscapes> scriptDebuggerEscapes, uint64_t seed );
   ~Core();
 
   CpuBreakType advanceAudio( int sps, std::span<AudioSample> outputBuffer, RunMode runMode );
   CpuBreakType run( RunMode runMode );
-
-  void setLog( std::filesystem::path const & path );
+  //runs until the first instruction boundary at or after given tick
+  CpuBreakType runUntil( uint64_t tick );
+  //runs until given number of frames have started, i.e. until the first instruction boundary after as many video sink newFrame calls
+  CpuBreakType runFrames( uint64_t count );
+
+  //CPU is between instructions, Suzy is idle and EEPROM is not in a command
+  bool snapshotReady() const;
+  //runs instruction by instruction for at most given number of ticks until snapshotReady
+  CpuBreakType runToSnapshotBoundary( uint64_t maxTicks );
+  //writes versioned machine state into out reusing its storage. Returns false if not snapshotReady
+  bool snapshot( std::vector<uint8_t> & out );
+  //restores state saved by a Core running the same image. Returns false on version mismatch or malformed data
+  bool restore( std::span<uint8_t const> data );
+
+  //video sink receives nothing while muted
+  void muteVideo( bool muted );
+  //speculatively finishes current frame and emulates given number of frames more with video muted, emulates the next one
+  //with video on so that it is presented, and restores current state using given storage. Audio is only produced by advanceAudio,
+  //VGM output is suspended. Other machines on ComLynx wire would see speculative traffic, as would CPU trace log and script traps,
+  //so callers should not run ahead while they are set. Returns false if the state can't be saved
+  bool runAhead( int frames, std::vector<uint8_t> & state );
+
+  //fingerprint of machine state for comparing runs of differently driven cores
+  struct StateHash
+  {
+    uint64_t tick;
+    uint64_t cpu;
+    uint64_t ram;
+    uint64_t mikey;
+    uint64_t suzy;
+
+    bool operator==( StateHash const& other ) const = default;
+  };
+
+  //cheap enough to be taken every frame. CPU must be at instruction boundary
+  StateHash stateHash();
+
+  //input is latched once per frame by default, per scanline for games that need lower latency
+  void latchInputPerScanline( bool value );
+  //writes binary trace of traced instructions accepted by filter
+  void setLog( std::filesystem::path const & path, CpuTraceFilter const& filter );
   void setVGMWriter( std::shared_ptr<VGMWriter> writer );
+  //attributes ticks from now on to guest code. Speculative run-ahead frames are not profiled
+  std::shared_ptr<Profiler> enableProfiler();
+  //counts memory accesses from now on. Speculative run-ahead frames are not counted
+  std::shared_ptr<Coverage> enableCoverage();
+  //called with frame count at the start of each frame. Not called for speculative run-ahead frames
+  void setFrameCallback( std::function<void( uint64_t )> callback );
+  //observes RAM writes of CPU, Suzy and debugger
+  std::shared_ptr<WriteMonitor> writeMonitor() const;
+  //holds RAM bytes at fixed values
+  std::shared_ptr<RamFreeze> ramFreeze() const;
+  //host side work done since power on, zero unless built with performance counters
+  PerfCounters perfCounters() const;
 
   void enterMonitor();
   int64_t globalSamplesEmittedPerFrame() const;
 
   uint64_t tick() const;
+  uint64_t seed() const;
+  //number of frames started since power on. Not part of the snapshot
+  uint64_t frameCount() const;
 
   //Not thread safe. Used only for script escapes
   uint8_t debugReadROM( uint16_t address ) const;
@@ -57,6 +120,8 @@ public:
   uint16_t debugVidBas() const;
   uint16_t debugCollBas() const;
   std::span<uint8_t const, 32> debugPalette() const;
+  //copies state shown by debugger windows. Called on emulation thread
+  void debugCapture( DebugView & view ) const;
   std::shared_ptr<TraceHelper> getTraceHelper() const;
   std::shared_ptr<ScriptDebugger> getScriptDebugger() const;
 
@@ -79,6 +144,7 @@ private:
     bool suzyDisable;
   };
 
+  void serialize( Snapshot & snapshot );
   void executeSequencedAction( SequencedAction );
   bool executeSuzyAction();
   CpuBreakType executeCPUAction();
@@ -87,6 +153,8 @@ private:
   uint8_t fetchRAM( uint16_t address );
   uint8_t readRAM( uint16_t address );
   void writeRAM( uint16_t address, uint8_t value );
+  //notifies write monitor of RAM written by Suzy
+  void suzyWritten( uint16_t address, int size );
   uint8_t readMikey( uint16_t address );
   void writeMikey( uint16_t address, uint8_t value );
   uint8_t readSuzy( uint16_t address );
@@ -118,6 +186,7 @@ private:
   std::array<uint8_t, 65536> mRAM;
   std::array<uint8_t, 512> mROM;
   std::array<PageType, 256> mPageTypes;
+  uint64_t mSeed;
   std::shared_ptr<ScriptDebugger> mScriptDebugger;
   uint64_t mCurrentTick;
   int mSamplesRemainder;
@@ -127,6 +196,18 @@ private:
   uint64_t mGlobalSamplesEmitted;
   uint64_t mGlobalSamplesEmittedSnapshot;
   int64_t mGlobalSamplesEmittedPerFrame;
+  uint64_t mFrameCount;
+  //frame count at which runFrames breaks, 0 if none
+  uint64_t mFrameBreak;
+  bool mVideoMuted;
+  bool mInputPerScanline;
+  std::vector<uint8_t> mStateHashScratch;
+  std::shared_ptr<Profiler> mProfiler;
+  std::shared_ptr<Coverage> mCoverage;
+  std::function<void( uint64_t )> mFrameCallback;
+  std::shared_ptr<WriteMonitor> mWriteMonitor;
+  std::shared_ptr<RamFreeze> mRamFreeze;
+  PerfCounters mPerfCounters;
   ActionQueue mActionQueue;
   std::shared_ptr<TraceHelper> mTraceHelper;
   std::shared_ptr<CPU> mCpu;
@@ -135,6 +216,7 @@ private:
   std::shared_ptr<ComLynxWire> mComLynxWire;
   std::shared_ptr<Mikey> mMikey;
   std::shared_ptr<Suzy> mSuzy;
+  std::shared_ptr<IInputSource> mInputSource;
   MAPCTL mMapCtl;
   uint64_t mFastCycleTick;
   uint64_t mPatchMagickCodeAccumulator;
@@ -0,0 +1,76 @@
+#include "pch.hpp"
+#include "Coverage.hpp"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#define STBI_MSC_SECURE_CRT
+#include "stb_image_write.h"
+
+Coverage::Coverage() : mExecute( SIZE ), mRead( SIZE ), mWrite( SIZE ), mFrame( SIZE ), mOpcodes( ROM / 64 ), mFrames{}
+{
+}
+
+bool Coverage::recordFrames( std::filesystem::path const& path )
+{
+  mFrames.open( path, std::ios::binary | std::ios::trunc );
+  Header header{ MAGIC, VERSION, SIZE, 0 };
+  mFrames.write( (char const*)&header, sizeof( header ) );
+  return mFrames.good();
+}
+
+void Coverage::newFrame( uint64_t frame )
+{
+  if ( mFrames.is_open() )
+  {
+    //frame number followed by access bits of all cells
+    mFrames.write( (char const*)&frame, sizeof( frame ) );
+    mFrames.write( (char const*)mFrame.data(), mFrame.size() );
+  }
+
+  std::fill( mFrame.begin(), mFrame.end(), 0 );
+}
+
+std::span<uint64_t const> Coverage::opcodes() const
+{
+  return mOpcodes;
+}
+
+bool Coverage::write( std::filesystem::path const& path ) const
+{
+  std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+  Header header{ MAGIC, VERSION, SIZE, 0 };
+  out.write( (char const*)&header, sizeof( header ) );
+  for ( auto const* counters : { &mExecute, &mRead, &mWrite } )
+  {
+    out.write( (char const*)counters->data(), counters->size() * sizeof( uint32_t ) );
+  }
+  return out.good();
+}
+
+bool Coverage::writeHeatmap( std::filesystem::path const& path ) const
+{
+  static constexpr int WIDTH = 256;
+  static constexpr int HEIGHT = SIZE / WIDTH;
+
+  std::vector<uint8_t> image( SIZE * 3 );
+
+  auto channel = [&]( std::vector<uint32_t> const& counters, int offset )
+  {
+    uint32_t max = *std::max_element( counters.cbegin(), counters.cend() );
+    if ( max == 0 )
+      return;
+
+    //logarithmic scale keeps rarely accessed addresses visible
+    double scale = 255.0 / std::log2( 1.0 + max );
+    for ( uint32_t i = 0; i < SIZE; ++i )
+    {
+      if ( counters[i] )
+        image[i * 3 + offset] = (uint8_t)std::max( 1.0, std::log2( 1.0 + counters[i] ) * scale );
+    }
+  };
+
+  channel( mWrite, 0 );
+  channel( mExecute, 1 );
+  channel( mRead, 2 );
+
+  return stbi_write_png( path.string().c_str(), WIDTH, HEIGHT, 3, image.data(), WIDTH * 3 ) != 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+//Counts execute, read and write accesses per address of RAM, boot ROM and Suzy and Mikey register pages.
+//CPU accesses and Suzy sprite engine RAM accesses are counted, operand fetches count as execution.
+//Counters saturate, accesses of the current frame are kept as bits besides them.
+class Coverage
+{
+public:
+  static constexpr uint32_t MAGIC = 0x56434c46; //"FLCV"
+  static constexpr uint32_t VERSION = 1;
+
+  //cell of the first address of each region
+  static constexpr uint32_t RAM = 0;
+  static constexpr uint32_t ROM = 0x10000;
+  static constexpr uint32_t SUZY = 0x10200;
+  static constexpr uint32_t MIKEY = 0x10300;
+  static constexpr uint32_t SIZE = 0x10400;
+
+  //bits of frame map
+  static constexpr uint8_t EXECUTE = 1;
+  static constexpr uint8_t READ = 2;
+  static constexpr uint8_t WRITE = 4;
+
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cells;
+    uint32_t reserved;
+  };
+
+  Coverage();
+
+  void execute( uint32_t cell )
+  {
+    count( mExecute, cell, EXECUTE );
+  }
+
+  //execution of opcode also marks the instruction start
+  void executeOpcode( uint32_t cell )
+  {
+    count( mExecute, cell, EXECUTE );
+    if ( cell < ROM )
+      mOpcodes[cell >> 6] |= 1ull << ( cell & 63 );
+  }
+
+  void read( uint32_t cell )
+  {
+    count( mRead, cell, READ );
+  }
+
+  void write( uint32_t cell )
+  {
+    count( mWrite, cell, WRITE );
+  }
+
+  //appends access bits of each frame to path from now on
+  bool recordFrames( std::filesystem::path const& path );
+  void newFrame( uint64_t frame );
+
+  //bitmap of RAM addresses opcodes were executed from, 64 addresses per word
+  std::span<uint64_t const> opcodes() const;
+
+  //header followed by execute, read and write counters of all cells
+  bool write( std::filesystem::path const& path ) const;
+  //256 pixels wide image of RAM followed by ROM, Suzy and Mikey rows. Writes are red, execution green and reads blue
+  bool writeHeatmap( std::filesystem::path const& path ) const;
+
+private:
+  void count( std::vector<uint32_t> & counters, uint32_t cell, uint8_t bit )
+  {
+    auto & counter = counters[cell];
+    counter += counter != std::numeric_limits<uint32_t>::max();
+    mFrame[cell] |= bit;
+  }
+
+private:
+  std::vector<uint32_t> mExecute;
+  std::vector<uint32_t> mRead;
+  std::vector<uint32_t> mWrite;
+  std::vector<uint8_t> mFrame;
+  std::vector<uint64_t> mOpcodes;
+  std::ofstream mFrames;
+};
@@ -0,0 +1,142 @@
+#include "pch.hpp"
+#include "CpuTrace.hpp"
+
+CpuTrace CpuTrace::make( uint64_t tick, CPUState const& before, CPUState const& after, size_t commentSize )
+{
+  CpuTrace result{};
+  result.tick = tick;
+  result.pc = before.pc;
+  result.ea = after.ea;
+  result.fa = after.fa;
+  result.t = after.t;
+  result.commentSize = (uint16_t)commentSize;
+  result.op = after.op;
+  result.interrupt = after.interrupt;
+  result.a = before.a;
+  result.x = before.x;
+  result.y = before.y;
+  result.s = before.sl;
+  result.p = before.getP();
+  result.m1 = after.m1;
+  result.m2 = after.m2;
+  return result;
+}
+
+void CpuTrace::restore( CPUState & before, CPUState & after ) const
+{
+  before.pc = pc;
+  before.a = a;
+  before.x = x;
+  before.y = y;
+  before.s = 0x100 | s;
+  before.setP( p );
+  before.padding = ' ';
+  after.ea = ea;
+  after.fa = fa;
+  after.t = t;
+  after.op = op;
+  after.interrupt = interrupt;
+  after.m1 = m1;
+  after.m2 = m2;
+}
+
+CpuTraceWriter::CpuTraceWriter( std::filesystem::path const& path, CpuTraceFilter const& filter, uint64_t const& tick ) : mOut{ path, std::ios::binary | std::ios::trunc },
+  mFilter{ filter }, mTick{ tick }, mStartTick{}, mBuffer{}, mMutex{}, mCondition{}, mPending{}, mFree{}, mFinished{}, mThread{}
+{
+  CpuTrace::Header header{ CpuTrace::MAGIC, CpuTrace::VERSION };
+  mOut.write( (char const*)&header, sizeof( header ) );
+  mBuffer.reserve( BUFFER_SIZE );
+
+  mThread = std::thread{ [this]
+  {
+    writer();
+  } };
+}
+
+CpuTraceWriter::~CpuTraceWriter()
+{
+  flush();
+  {
+    std::scoped_lock<std::mutex> l{ mMutex };
+    mFinished = true;
+  }
+  mCondition.notify_all();
+  if ( mThread.joinable() )
+    mThread.join();
+}
+
+bool CpuTraceWriter::good() const
+{
+  return mOut.good();
+}
+
+void CpuTraceWriter::start()
+{
+  mStartTick = mTick;
+}
+
+void CpuTraceWriter::write( CPUState const& before, CPUState const& after, std::string_view comment )
+{
+  if ( !mFilter.accepts( before.pc, mStartTick ) )
+    return;
+
+  comment = comment.substr( 0, std::numeric_limits<uint16_t>::max() );
+  auto record = CpuTrace::make( mStartTick, before, after, comment.size() );
+
+  size_t size = mBuffer.size();
+  mBuffer.resize( size + sizeof( record ) + comment.size() );
+  std::memcpy( mBuffer.data() + size, &record, sizeof( record ) );
+  std::memcpy( mBuffer.data() + size + sizeof( record ), comment.data(), comment.size() );
+
+  if ( mBuffer.size() >= BUFFER_SIZE )
+    flush();
+}
+
+void CpuTraceWriter::flush()
+{
+  if ( mBuffer.empty() )
+    return;
+
+  {
+    std::unique_lock<std::mutex> l{ mMutex };
+    mCondition.wait( l, [this] { return mPending.size() < MAX_PENDING; } );
+    mPending.push_back( std::move( mBuffer ) );
+    if ( mFree.empty() )
+    {
+      mBuffer = {};
+    }
+    else
+    {
+      mBuffer = std::move( mFree.back() );
+      mFree.pop_back();
+    }
+  }
+  mCondition.notify_all();
+
+  mBuffer.clear();
+  mBuffer.reserve( BUFFER_SIZE );
+}
+
+void CpuTraceWriter::writer()
+{
+  for ( ;; )
+  {
+    std::vector<uint8_t> buffer;
+    {
+      std::unique_lock<std::mutex> l{ mMutex };
+      mCondition.wait( l, [this] { return mFinished || !mPending.empty(); } );
+      //everything flushed before destruction is written
+      if ( mPending.empty() )
+        return;
+      buffer = std::move( mPending.front() );
+      mPending.pop_front();
+    }
+    mCondition.notify_all();
+
+    mOut.write( (char const*)buffer.data(), buffer.size() );
+
+    buffer.clear();
+    std::scoped_lock<std::mutex> l{ mMutex };
+    mFree.push_back( std::move( buffer ) );
+  }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "CPUState.hpp"
+
+//Binary trace of executed instructions.
+//The file is a header followed by fixed size records, each followed by the trace comment of its instruction if it has one.
+//Records hold what is needed to print the trace line, FelixTrace converts them to text.
+struct CpuTrace
+{
+  static constexpr uint32_t MAGIC = 0x52544c46; //"FLTR"
+  static constexpr uint32_t VERSION = 1;
+
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t version;
+  };
+
+  //tick at the end of opcode fetch
+  uint64_t tick;
+  //registers before the instruction
+  uint16_t pc;
+  //operand, effective and final addresses as decoded by the instruction
+  uint16_t ea;
+  uint16_t fa;
+  uint16_t t;
+  //number of comment bytes following the record
+  uint16_t commentSize;
+  Opcode op;
+  uint8_t interrupt;
+  uint8_t a;
+  uint8_t x;
+  uint8_t y;
+  uint8_t s;
+  uint8_t p;
+  //values read and written by the instruction
+  uint8_t m1;
+  uint8_t m2;
+  uint8_t reserved[5];
+
+  static CpuTrace make( uint64_t tick, CPUState const& before, CPUState const& after, size_t commentSize );
+  //states as seen by trace formatting
+  void restore( CPUState & before, CPUState & after ) const;
+};
+
+static_assert( sizeof( CpuTrace ) == 32 );
+
+//Instructions outside of both ranges are not recorded
+struct CpuTraceFilter
+{
+  uint16_t firstPC = 0;
+  uint16_t lastPC = 0xffff;
+  uint64_t firstTick = 0;
+  uint64_t lastTick = std::numeric_limits<uint64_t>::max();
+
+  bool accepts( uint16_t pc, uint64_t tick ) const
+  {
+    return pc >= firstPC && pc <= lastPC && tick >= firstTick && tick <= lastTick;
+  }
+};
+
+//Writes trace records on a background thread.
+//Records are appended to a buffer owned by emulation thread and full buffers are handed over to the writer thread.
+class CpuTraceWriter
+{
+public:
+  //tick is read at the start of each instruction
+  CpuTraceWriter( std::filesystem::path const& path, CpuTraceFilter const& filter, uint64_t const& tick );
+  ~CpuTraceWriter();
+
+  bool good() const;
+
+  //called after opcode fetch
+  void start();
+  void write( CPUState const& before, CPUState const& after, std::string_view comment );
+  //passes collected records to the writer thread
+  void flush();
+
+private:
+  void writer();
+
+private:
+  static constexpr size_t BUFFER_SIZE = 1 << 20;
+  //emulation waits for the writer thread when this many buffers are pending
+  static constexpr size_t MAX_PENDING = 64;
+
+  std::ofstream mOut;
+  CpuTraceFilter mFilter;
+  uint64_t const& mTick;
+  uint64_t mStartTick;
+  std::vector<uint8_t> mBuffer;
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::deque<std::vector<uint8_t>> mPending;
+  std::vector<std::vector<uint8_t>> mFree;
+  bool mFinished;
+  std::thread mThread;
+};
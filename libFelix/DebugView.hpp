@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CPUState.hpp"
+#include "PerfCounters.hpp"
+#include "Utility.hpp"
+
+class WriteMonitor;
+
+//Copy of emulated state read by debugger windows.
+//Taken on emulation thread between batches, so windows never see a half updated frame nor race with emulation.
+struct DebugView
+{
+  static constexpr size_t SCREEN_SIZE = SCREEN_WIDTH * SCREEN_HEIGHT / 2;
+
+  //screen sized tail repeats the start of RAM so that a screen can be viewed from any address
+  std::array<uint8_t, 0x10000 + SCREEN_SIZE> ram;
+  CPUState cpu;
+  std::array<uint8_t, 32> palette;
+  uint16_t dispAdr;
+  uint16_t vidBas;
+  uint16_t collBas;
+  uint64_t tick;
+  //RAM addresses opcodes were executed from, known only when coverage is counted
+  std::array<uint64_t, 0x10000 / 64> opcodes;
+  //writes recorded by the monitor up to the sequence are in ram
+  WriteMonitor const* writeMonitor;
+  uint64_t writeSequence;
+  PerfCounters perf;
+
+  std::span<uint8_t const> screen( uint16_t address ) const
+  {
+    return std::span<uint8_t const>{ ram.data() + address, SCREEN_SIZE };
+  }
+};
+
+//Passes values from one writer thread to one reader thread without either of them waiting.
+//Writer fills the back buffer and swaps it with the middle one, reader takes the middle one if it was published since.
+template<typename T>
+class TripleBuffer
+{
+public:
+  TripleBuffer() : mBuffers{}, mBack{ 0 }, mMiddle{ 1 }, mFront{ 2 }
+  {
+  }
+
+  T & back()
+  {
+    return mBuffers[mBack];
+  }
+
+  void publish()
+  {
+    mBack = mMiddle.exchange( mBack | FRESH, std::memory_order_acq_rel ) & INDEX;
+  }
+
+  //latest published value, valid until the next call
+  T const& front()
+  {
+    if ( mMiddle.load( std::memory_order_relaxed ) & FRESH )
+      mFront = mMiddle.exchange( mFront, std::memory_order_acq_rel ) & INDEX;
+
+    return mBuffers[mFront];
+  }
+
+private:
+  static constexpr uint8_t INDEX = 3;
+  static constexpr uint8_t FRESH = 4;
+
+  std::array<T, 3> mBuffers;
+  uint8_t mBack;
+  std::atomic<uint8_t> mMiddle;
+  uint8_t mFront;
+};
@@ -0,0 +1,159 @@
+#include "pch.hpp"
+#include "DisassemblyCache.hpp"
+#include "CPU.hpp"
+#include "Opcodes.hpp"
+
+DisassemblyCache::DisassemblyCache( CPU & cpu ) : mCpu{ cpu }, mSizes{}, mRAM( 0x10000 + 2 ), mSeeds{}, mRows( 0x10000 ), mText( 0x10000 )
+{
+  //operands of opcode at 0 are zeros
+  std::vector<uint8_t> scratch( 0x10000 + 2 );
+  std::array<char, 2048> buf;
+  for ( size_t op = 0; op < mSizes.size(); ++op )
+  {
+    scratch[0] = (uint8_t)op;
+    int pc = 0;
+    mSizes[op] = (uint8_t)( 1 + mCpu.disasmOpr( scratch.data(), buf.data(), pc ) );
+  }
+
+  layout( 0, 0x10000 );
+}
+
+void DisassemblyCache::update( std::span<uint8_t const> ram )
+{
+  assert( ram.size() >= 0x10000 );
+
+  static constexpr size_t PAGE = 256;
+
+  for ( size_t page = 0; page < 0x10000; page += PAGE )
+  {
+    auto begin = ram.begin() + page;
+    auto first = std::mismatch( begin, begin + PAGE, mRAM.begin() + page ).first;
+    if ( first == begin + PAGE )
+      continue;
+
+    //changed bytes are laid out up to the end of the page, the sweep stops as soon as it meets the old layout
+    uint16_t address = (uint16_t)( first - ram.begin() );
+    std::copy( first, begin + PAGE, mRAM.begin() + address );
+    layout( rowStart( address ), page + PAGE );
+  }
+}
+
+void DisassemblyCache::seed( uint16_t address )
+{
+  if ( isSeed( address ) )
+    return;
+
+  mSeeds[address >> 6] |= 1ull << ( address & 63 );
+  if ( mRows[address] == 0 )
+    layout( rowStart( address ), address + 1 );
+}
+
+void DisassemblyCache::seed( std::span<uint64_t const> starts )
+{
+  for ( size_t i = 0; i < std::min( starts.size(), mSeeds.size() ); ++i )
+  {
+    for ( uint64_t fresh = starts[i] & ~mSeeds[i]; fresh != 0; fresh &= fresh - 1 )
+    {
+      seed( (uint16_t)( i * 64 + std::countr_zero( fresh ) ) );
+    }
+  }
+}
+
+uint16_t DisassemblyCache::rowStart( uint16_t address ) const
+{
+  while ( mRows[address] == 0 )
+  {
+    address -= 1;
+  }
+  return address;
+}
+
+uint8_t DisassemblyCache::rowSize( uint16_t address ) const
+{
+  return mRows[rowStart( address )] & SIZE;
+}
+
+bool DisassemblyCache::isData( uint16_t address ) const
+{
+  return ( mRows[rowStart( address )] & DATA ) != 0;
+}
+
+bool DisassemblyCache::nextRow( uint16_t & address ) const
+{
+  uint32_t next = (uint32_t)rowStart( address ) + rowSize( address );
+  if ( next > 0xffff )
+    return false;
+
+  address = (uint16_t)next;
+  return true;
+}
+
+bool DisassemblyCache::previousRow( uint16_t & address ) const
+{
+  uint16_t start = rowStart( address );
+  if ( start == 0 )
+    return false;
+
+  address = rowStart( start - 1 );
+  return true;
+}
+
+std::string_view DisassemblyCache::text( uint16_t address )
+{
+  address = rowStart( address );
+  auto & text = mText[address];
+  if ( !text.empty() )
+    return text;
+
+  std::array<char, 2048> buf{};
+  if ( mRows[address] & DATA )
+  {
+    text = fmt::format( ".db  ${:02x}", mRAM[address] );
+  }
+  else
+  {
+    int pc = address;
+    CPU::disasmOp( buf.data(), (Opcode)mRAM[address] );
+    mCpu.disasmOpr( mRAM.data(), buf.data() + 5, pc );
+    //values after the tab depend on state at the time of formatting
+    std::string_view operand{ buf.data() + 5 };
+    text.assign( buf.data(), 5 );
+    text.append( operand.substr( 0, operand.find( '\t' ) ) );
+  }
+  return text;
+}
+
+bool DisassemblyCache::isSeed( uint32_t address ) const
+{
+  return address < 0x10000 && ( mSeeds[address >> 6] & ( 1ull << ( address & 63 ) ) ) != 0;
+}
+
+void DisassemblyCache::layout( uint16_t begin, uint32_t end )
+{
+  uint32_t address = begin;
+
+  //rows past end do not change once the sweep lands on one of them
+  while ( address < 0x10000 && ( address < end || mRows[address] == 0 ) )
+  {
+    uint8_t size = mSizes[mRAM[address]];
+    uint8_t row = size;
+    for ( uint32_t i = 1; i < size; ++i )
+    {
+      if ( isSeed( address + i ) || address + i > 0xffff )
+      {
+        size = 1;
+        row = 1 | DATA;
+        break;
+      }
+    }
+
+    mRows[address] = row;
+    mText[address].clear();
+    for ( uint32_t i = 1; i < size; ++i )
+    {
+      mRows[address + i] = 0;
+      mText[address + i].clear();
+    }
+    address += size;
+  }
+}
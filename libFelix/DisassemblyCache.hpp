@@ -0,0 +1,52 @@
+#pragma once
+
+class CPU;
+
+//Disassembly of RAM kept between refreshes of the disassembly view.
+//RAM is laid out as rows, each an instruction or a data byte, sweeping forward from address 0.
+//Known instruction starts (executed opcodes, symbols and seen program counters) keep the sweep in step with code:
+//an instruction that would cover one is shown as data bytes instead.
+//Rows are laid out again only from the first row touched by changed RAM or a new start until they meet the old layout.
+class DisassemblyCache
+{
+public:
+  //instruction sizes are taken from the disassembler of cpu
+  explicit DisassemblyCache( CPU & cpu );
+
+  //compares ram with the copy of the previous update and lays out changed ranges
+  void update( std::span<uint8_t const> ram );
+  void seed( uint16_t address );
+  //bitmap of instruction starts, 64 addresses per word
+  void seed( std::span<uint64_t const> starts );
+
+  //start of the row covering address
+  uint16_t rowStart( uint16_t address ) const;
+  uint8_t rowSize( uint16_t address ) const;
+  //row is shown as a data byte
+  bool isData( uint16_t address ) const;
+  //false after the last row
+  bool nextRow( uint16_t & address ) const;
+  //false before the first row
+  bool previousRow( uint16_t & address ) const;
+
+  //mnemonic padded to 5 characters followed by operand, without values of operands. Formatted once per layout
+  std::string_view text( uint16_t address );
+
+private:
+  static constexpr uint8_t SIZE = 0x0f;
+  //row is a data byte
+  static constexpr uint8_t DATA = 0x80;
+
+  bool isSeed( uint32_t address ) const;
+  void layout( uint16_t begin, uint32_t end );
+
+private:
+  CPU & mCpu;
+  std::array<uint8_t, 256> mSizes;
+  //copy of RAM the layout is made of, with room for operands of the last instruction
+  std::vector<uint8_t> mRAM;
+  std::array<uint64_t, 0x10000 / 64> mSeeds;
+  //size and flags of row starting at address, 0 inside a row
+  std::vector<uint8_t> mRows;
+  std::vector<std::string> mText;
+};
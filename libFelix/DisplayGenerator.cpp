@@ -2,9 +2,10 @@
 #include "DisplayGenerator.hpp"
 #include "IVideoSink.hpp"
 #include "Log.hpp"
+#include "Snapshot.hpp"
 
 DisplayGenerator::DisplayGenerator( std::shared_ptr<IVideoSink> videoSink ) : mDMAData{}, mVideoSink{ std::move( videoSink ) }, mRowStartTick{ std::numeric_limits<uint64_t>::max() }, mDMAIteration{}, mDisplayRow{}, mEmitedScreenBytes{},
-  mDispAdr{}, mDispColor{}, mDispFlip{}, mDMAEnable{}, mDMAOffset{ -1 }
+  mDispAdr{}, mDispColor{}, mDispFlip{}, mDMAEnable{}, mDMAOffset{ -1 }, mMuted{}
 {
   assert( mVideoSink );
 }
@@ -28,7 +29,8 @@ void DisplayGenerator::firstHblank( uint64_t tick, uint8_t hbackup )
   flushDisplay( tick );
   mEmitedScreenBytes = 0;
   mDMAIteration = 0;
-  mVideoSink->newFrame( tick, hbackup );
+  if ( !mMuted )
+    mVideoSink->newFrame( tick, hbackup );
   mRowStartTick = std::numeric_limits<uint64_t>::max();
 }
 
@@ -38,7 +40,8 @@ DisplayGenerator::DMARequest DisplayGenerator::hblank( uint64_t tick, int row )
   mEmitedScreenBytes = 0;
   mDMAIteration = 0;
   mDisplayRow = 101 - row;
-  mVideoSink->newRow( tick, row );
+  if ( !mMuted )
+    mVideoSink->newRow( tick, row );
   if ( mDisplayRow >= 0 && mDMAOffset >= 0 )
   {
     mRowStartTick = tick + mDMAOffset;
@@ -69,7 +72,8 @@ DisplayGenerator::DMARequest DisplayGenerator::pushData( uint64_t tick, uint64_t
 void DisplayGenerator::updatePalette( uint64_t tick, uint8_t reg, uint8_t value )
 {
   flushDisplay( tick );
-  mVideoSink->updateColorReg( reg, value );
+  if ( !mMuted )
+    mVideoSink->updateColorReg( reg, value );
 }
 
 void DisplayGenerator::updateDispAddr( uint64_t tick, uint16_t dispAdr )
@@ -97,7 +101,8 @@ bool DisplayGenerator::flushDisplay( uint64_t tick )
   bool const result = limit == 80 && mEmitedScreenBytes < 80;
   size_t bytesToEmit = limit - mEmitedScreenBytes;
   //NOTICE - pixels are processed in byte pairs, so in this implementation it is not possible to alter color register between nibbles of a screen byte
-  mVideoSink->emitScreenData( std::span<uint8_t const>( lineData + mEmitedScreenBytes, bytesToEmit ) );
+  if ( !mMuted )
+    mVideoSink->emitScreenData( std::span<uint8_t const>( lineData + mEmitedScreenBytes, bytesToEmit ) );
   mEmitedScreenBytes = limit;
 
   return result;
@@ -108,3 +113,29 @@ bool DisplayGenerator::rest() const
   return mDisplayRow < 103 && mDisplayRow > 99;
 }
 
+void DisplayGenerator::serialize( Snapshot & snapshot )
+{
+  snapshot.section( "DISP" );
+  snapshot( mDMAData, mRowStartTick, mDMAIteration, mDisplayRow, mEmitedScreenBytes, mDispAdr, mDispColor, mDispFlip, mDMAEnable, mDMAOffset );
+}
+
+void DisplayGenerator::mute( bool muted )
+{
+  mMuted = muted;
+}
+
+bool DisplayGenerator::muted() const
+{
+  return mMuted;
+}
+
+void DisplayGenerator::resendPalette( std::span<uint8_t const, 32> palette )
+{
+  if ( mMuted )
+    return;
+
+  for ( size_t i = 0; i < palette.size(); ++i )
+  {
+    mVideoSink->updateColorReg( (uint8_t)i, palette[i] );
+  }
+}
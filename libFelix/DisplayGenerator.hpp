@@ -4,6 +4,7 @@
 #include "Utility.hpp"
 
 struct IVideoSink;
+class Snapshot;
 
 class DisplayGenerator : public RestProvider
 {
@@ -38,6 +39,13 @@ public:
 
   bool rest() const override;
 
+  void serialize( Snapshot & snapshot );
+  //video sink receives nothing while muted, the display state is still maintained
+  void mute( bool muted );
+  bool muted() const;
+  //sends whole palette to video sink, e.g. after the state has been restored
+  void resendPalette( std::span<uint8_t const, 32> palette );
+
 private:
   bool flushDisplay( uint64_t tick );
 
@@ -53,6 +61,7 @@ private:
   bool mDispFlip;
   bool mDMAEnable;
   int mDMAOffset;
+  bool mMuted;
 
   static constexpr uint64_t DMA_ITERATIONS = 10;
   static constexpr uint64_t TICKS_PER_PIXEL = 12;
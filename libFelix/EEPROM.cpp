@@ -2,9 +2,11 @@
 #include "EEPROM.hpp"
 #include "ImageProperties.hpp"
 #include "TraceHelper.hpp"
+#include "Snapshot.hpp"
+#include "PerfCounters.hpp"
 
 EEPROM::EEPROM( std::filesystem::path imagePath, int eeType, bool is16Bit, std::shared_ptr<TraceHelper> traceHelper ) : mEECoroutine{}, mImagePath{ std::move( imagePath ) },
-  mTraceHelper{ std::move( traceHelper ) }, mData{}, mOpcodeBits{}, mAddressMask{}, mDataBits{}, mWriteEnable{}, mChanged{ true }
+  mTraceHelper{ std::move( traceHelper ) }, mData{}, mOpcodeBits{}, mAddressMask{}, mDataBits{}, mWriteEnable{}, mChanged{ true }, mResumes{}
 {
   assert( eeType > 0 && eeType < 6 );
 
@@ -100,6 +102,7 @@ void EEPROM::tick( uint64_t tick, bool cs, bool audin )
         io.currentTick = tick;
         io.input = audin;
 
+        perfCount( mResumes );
         mEECoroutine();
       }
     }
@@ -125,6 +128,32 @@ void EEPROM::tick( uint64_t tick, bool cs, bool audin )
   }
 }
 
+bool EEPROM::idle() const
+{
+  return !(bool)mEECoroutine;
+}
+
+uint64_t EEPROM::resumes() const
+{
+  return mResumes;
+}
+
+void EEPROM::serialize( Snapshot & snapshot )
+{
+  assert( !snapshot.saving() || idle() );
+
+  snapshot.section( "EEPR" );
+  snapshot( io, mWriteEnable );
+  snapshot( mData );
+
+  if ( snapshot.loading() )
+  {
+    mEECoroutine.reset();
+    //content may differ from the image file now
+    mChanged = true;
+  }
+}
+
 std::optional<bool> EEPROM::output( uint64_t tick ) const
 {
   if ( io.busyUntil < tick )
@@ -4,6 +4,7 @@
 class ImageCart;
 class TraceHelper;
 class ImageProperties;
+class Snapshot;
 
 class EEPROM
 {
@@ -17,6 +18,12 @@ public:
   void tick( uint64_t tick, bool cs, bool audin );
   std::optional<bool> output( uint64_t tick ) const;
 
+  //no command is in progress
+  bool idle() const;
+  void serialize( Snapshot & snapshot );
+  //counted only with performance counters
+  uint64_t resumes() const;
+
 private:
 
   struct NoCS {};
@@ -137,6 +144,7 @@ private:
     int mDataBits;
     bool mWriteEnable;
     bool mChanged;
+    uint64_t mResumes;
 
     static constexpr uint64_t WRITE_TICKS = 10 * 16;
     static constexpr uint64_t ERAL_TICKS = 15 * 16;
@@ -34,14 +34,14 @@ std::vector<uint8_t> decrypt( size_t blockcount, std::span<uint8_t const> encryp
     uint8_t sanityChek = decrypt( std::span<uint8_t const>{ encrypted.data() + 51 * i, 51 }, accumulator, result );
     if ( sanityChek != 0x15 )
     {
-      L_ERROR << "Sanity check #1 value for block " << i << " is 0x" << std::hex << sanityChek << " != 0x15";
+      L_ERROR << "Sanity check #1 value for block " << i << fmt::format( " is 0x{:x} != 0x15", sanityChek );
       return {};
     }
   }
 
   if ( ( accumulator & 0xff ) != 0 )
   {
-    L_ERROR << "Sanity check #2 final accumulator value 0x" << std::hex << ( accumulator & 0xff ) << " != 0x00";
+    L_ERROR << fmt::format( "Sanity check #2 final accumulator value 0x{:x} != 0x00", accumulator & 0xff );
     return {};
 
   }
@@ -3,11 +3,10 @@
 #include "CartBank.hpp"
 #include "ImageProperties.hpp"
 #include "Log.hpp"
+#include "PerfCounters.hpp"
 
-GameDrive::GameDrive( std::filesystem::path const& imagePath ) : mMemoryBank{}, mBasePath { imagePath.parent_path() }, mBuffer{}, mGDCoroutine{ process() }, mReadTick{}
+GameDrive::GameDrive( std::filesystem::path const& imagePath ) : mMemoryBank{}, mBasePath { imagePath.parent_path() }, mBuffer{}, mGDCoroutine{ process() }, mLastTick{}, mReadTick{}, mLastTimePoint{}, mResumes{}
 {
-  mBaseTime = std::chrono::steady_clock::now();
-  mLastTimePoint = 0;
 }
 
 GameDrive::~GameDrive()
@@ -38,6 +37,7 @@ void GameDrive::put( uint64_t tick, uint8_t value )
     mLastTick = tick;
     mBuffer.ready = false;
     mBuffer.value = value;
+    perfCount( mResumes );
     mGDCoroutine.resume();
   }
 }
@@ -47,6 +47,7 @@ uint8_t GameDrive::get( uint64_t tick )
   mLastTick = tick;
   mReadTick = std::nullopt;
   auto result = mBuffer.value;
+  perfCount( mResumes );
   mGDCoroutine.resume();
   return result;
 }
@@ -56,6 +57,11 @@ CartBank* GameDrive::getBank( uint64_t tick ) const
   return mProgrammedBank.get();
 }
 
+uint64_t GameDrive::resumes() const
+{
+  return mResumes;
+}
+
 GameDrive::GDCoroutine GameDrive::process()
 {
   std::filesystem::path base = mBasePath;
@@ -113,7 +119,7 @@ GameDrive::GDCoroutine GameDrive::process()
       path = base / fname;
       if ( std::filesystem::exists( path ) )
       {
-        L_DEBUG << "GD Open file " << path;
+        L_DEBUG << "GD Open file " << path.string();
         file.open( path, std::ios::binary | std::ios::in );
         uint32_t size = (uint32_t)std::filesystem::file_size( path );
         finData.resize( size );
@@ -123,7 +129,7 @@ GameDrive::GDCoroutine GameDrive::process()
       }
       else
       {
-        L_DEBUG << "GD File " << path << " open error";
+        L_DEBUG << "GD File " << path.string() << " open error";
         co_await putResult( FRESULT::NO_FILE );
       }
       break;
@@ -153,7 +159,7 @@ GameDrive::GDCoroutine GameDrive::process()
       {
         if ( offset > finData.size() )
         {
-          L_DEBUG << "GD File resized from " << finData.size() << " to " << offset << std::hex << "($" << offset << ")";
+          L_DEBUG << fmt::format( "GD File resized from {} to {}(${:x})", finData.size(), offset, offset );
           finData.resize( offset );
         }
         L_DEBUG << "GD File seek " << offset;
@@ -169,15 +175,15 @@ GameDrive::GDCoroutine GameDrive::process()
 
       if ( fileOffset < finData.size() && fileOffset + size <= finData.size() )
       {
-        L_DEBUG << "GD Read " << size << "\t[" << fileOffset << "," << fileOffset + size << ")\t\t$" << std::hex << size << "\t[$" << fileOffset << ",$" << fileOffset + size << ")";
+        L_DEBUG << fmt::format( "GD Read {0}\t[{1},{2})\t\t${0:x}\t[${1:x},${2:x})", size, fileOffset, fileOffset + size );
       }
       else if ( fileOffset < finData.size() && fileOffset + size > finData.size() )
       {
-        L_DEBUG << "GD Read " << size << "\t[" << fileOffset << "," << finData.size() << ") | " << fileOffset + size - finData.size() << " * 0\t\t$" << std::hex << size << "\t[$" << fileOffset << ",$" << finData.size() << ") | $" << fileOffset + size - finData.size() << " * 0";
+        L_DEBUG << fmt::format( "GD Read {0}\t[{1},{2}) | {3} * 0\t\t${0:x}\t[${1:x},${2:x}) | ${3:x} * 0", size, fileOffset, finData.size(), fileOffset + size - finData.size() );
       }
       else
       {
-        L_DEBUG << "GD Read " << size << "\t" << size << " * 0\t\t$" << std::hex << size << "\t$" << size << " * 0";
+        L_DEBUG << fmt::format( "GD Read {0}\t{0} * 0\t\t${0:x}\t${0:x} * 0", size );
       }
 
       while ( size-- > 0 )
@@ -245,17 +251,14 @@ GameDrive::GDCoroutine GameDrive::process()
         }
         mProgrammedBank = std::make_shared<CartBank>( std::span<uint8_t const>{ mMemoryBank.data(), mMemoryBank.size() } );
         {
-          auto now = std::chrono::steady_clock::now();
-          auto diff = std::chrono::duration_cast<std::chrono::milliseconds>( now - mBaseTime );
-          double timePoint = (double)diff.count() / 1000.0;
+          //emulated time, so that runs are reproducible
+          double timePoint = (double)mLastTick / 16000000.0;
           L_DEBUG << "start program: " << ( timePoint - mLastTimePoint );
           mLastTimePoint = timePoint;
         }
         co_await putResult( FRESULT::OK, blockCount * blockSize * programByteLatency );
         {
-          auto now = std::chrono::steady_clock::now();
-          auto diff = std::chrono::duration_cast<std::chrono::milliseconds>( now - mBaseTime );
-          double timePoint = (double)diff.count() / 1000.0;
+          double timePoint = (double)mLastTick / 16000000.0;
           L_DEBUG << "end program: " << ( timePoint - mLastTimePoint );
           mLastTimePoint = timePoint;
         }
@@ -40,6 +40,8 @@ public:
   void put( uint64_t tick, uint8_t value );
   uint8_t get( uint64_t tick );
   CartBank* getBank( uint64_t tick ) const;
+  //counted only with performance counters
+  uint64_t resumes() const;
 
   GameDrive( std::filesystem::path const& imagePath );
   ~GameDrive();
@@ -134,6 +136,6 @@ private:
 
   private:
   GDCoroutine process();
-  std::chrono::steady_clock::time_point mBaseTime;
   double mLastTimePoint;
+  uint64_t mResumes;
 };
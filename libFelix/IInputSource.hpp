@@ -5,6 +5,15 @@ class KeyInput
   uint32_t data;
 public:
 
+  KeyInput() : data{}
+  {
+  }
+
+  //joystick in low byte, switches in high byte
+  explicit KeyInput( uint32_t raw ) : data{ raw }
+  {
+  }
+
   enum Key : uint32_t
   {
     OUTER   = 0,
@@ -33,6 +42,11 @@ public:
     data |= ( data & ~bitmask( k ) ) | ( value ? bitmask( k ) : 0 );
   }
 
+  uint32_t raw() const
+  {
+    return data;
+  }
+
   uint8_t joystick() const
   {
     return data & 0xff;
@@ -49,5 +63,8 @@ class IInputSource
 public:
   virtual ~IInputSource() = default;
 
-  virtual KeyInput getInput( bool leftHand ) const = 0;
+  //called on emulation thread when Suzy latches input at given tick
+  virtual KeyInput getInput( bool leftHand, uint64_t tick ) const = 0;
+  //called when a new frame starts in the video sink
+  virtual void newFrame( uint64_t frame, uint64_t tick ) {}
 };
@@ -0,0 +1,196 @@
+#include "pch.hpp"
+#include "InputMovie.hpp"
+#include "Utility.hpp"
+
+namespace
+{
+
+void writeVarint( std::vector<uint8_t> & out, uint64_t value )
+{
+  while ( value >= 0x80 )
+  {
+    out.push_back( (uint8_t)( value | 0x80 ) );
+    value >>= 7;
+  }
+  out.push_back( (uint8_t)value );
+}
+
+//returns false if value does not end before end of data
+bool readVarint( std::span<uint8_t const> data, size_t & offset, uint64_t & value )
+{
+  value = 0;
+  for ( int shift = 0; shift < 64 && offset < data.size(); shift += 7 )
+  {
+    uint8_t byte = data[offset++];
+    value |= (uint64_t)( byte & 0x7f ) << shift;
+    if ( ( byte & 0x80 ) == 0 )
+      return true;
+  }
+  return false;
+}
+
+static constexpr size_t INPUT_SIZE = 2;
+
+}
+
+InputRecorder::InputRecorder( std::shared_ptr<IInputSource> source, std::filesystem::path const& path, uint64_t seed ) : mSource{ std::move( source ) },
+  mOut{ path, std::ios::binary | std::ios::trunc }, mBuffer{}, mLast{}, mFrameTick{}
+{
+  InputMovie::Header header{ InputMovie::MAGIC, InputMovie::VERSION, seed };
+  mOut.write( (char const*)&header, sizeof( header ) );
+}
+
+InputRecorder::~InputRecorder()
+{
+  mOut.write( (char const*)mBuffer.data(), mBuffer.size() );
+}
+
+bool InputRecorder::good() const
+{
+  return mOut.good();
+}
+
+KeyInput InputRecorder::getInput( bool leftHand, uint64_t tick ) const
+{
+  auto input = mSource->getInput( leftHand, tick );
+  uint32_t value = input.raw();
+  if ( value != mLast )
+  {
+    mLast = value;
+    mBuffer.push_back( InputMovie::INPUT );
+    writeVarint( mBuffer, tick - mFrameTick );
+    mBuffer.push_back( (uint8_t)value );
+    mBuffer.push_back( (uint8_t)( value >> 8 ) );
+  }
+  return input;
+}
+
+void InputRecorder::newFrame( uint64_t frame, uint64_t tick )
+{
+  mSource->newFrame( frame, tick );
+
+  mBuffer.push_back( InputMovie::FRAME );
+  writeVarint( mBuffer, tick - mFrameTick );
+  mFrameTick = tick;
+
+  //one write per frame keeps the file complete up to the last frame
+  mOut.write( (char const*)mBuffer.data(), mBuffer.size() );
+  mBuffer.clear();
+}
+
+std::shared_ptr<InputPlayer> InputPlayer::load( std::filesystem::path const& path )
+{
+  auto data = readFile( path );
+
+  InputMovie::Header header{};
+  if ( data.size() < sizeof( header ) )
+    return {};
+  std::memcpy( &header, data.data(), sizeof( header ) );
+  if ( header.magic != InputMovie::MAGIC || header.version != InputMovie::VERSION )
+    return {};
+
+  return std::shared_ptr<InputPlayer>( new InputPlayer{ std::move( data ), header.seed } );
+}
+
+InputPlayer::InputPlayer( std::vector<uint8_t> data, uint64_t seed ) : mData{ std::move( data ) }, mFrames{}, mSeed{ seed }, mOffset{}, mInput{}, mFrame{}, mFrameTick{}
+{
+  size_t offset = sizeof( InputMovie::Header );
+  uint32_t input = 0;
+  mFrames.push_back( FrameStart{ offset, input } );
+
+  //index of frame starts, also drops a record cut off by an interrupted recording
+  size_t end = offset;
+  while ( offset < mData.size() )
+  {
+    uint8_t record = mData[offset++];
+    uint64_t ticks;
+    if ( record > InputMovie::INPUT || !readVarint( mData, offset, ticks ) )
+      break;
+    if ( record == InputMovie::INPUT )
+    {
+      if ( mData.size() - offset < INPUT_SIZE )
+        break;
+      input = mData[offset] | ( mData[offset + 1] << 8 );
+      offset += INPUT_SIZE;
+    }
+    else
+    {
+      mFrames.push_back( FrameStart{ offset, input } );
+    }
+    end = offset;
+  }
+
+  mData.resize( end );
+  mOffset = mFrames.front().offset;
+}
+
+uint64_t InputPlayer::seed() const
+{
+  return mSeed;
+}
+
+uint64_t InputPlayer::frames() const
+{
+  return mFrames.size();
+}
+
+uint64_t InputPlayer::frame() const
+{
+  return mFrame;
+}
+
+uint64_t InputPlayer::frameTick() const
+{
+  return mFrameTick;
+}
+
+bool InputPlayer::finished() const
+{
+  return mOffset >= mData.size();
+}
+
+bool InputPlayer::seek( uint64_t frame, uint64_t frameTick )
+{
+  if ( frame >= mFrames.size() )
+    return false;
+
+  mOffset = mFrames[frame].offset;
+  mInput = mFrames[frame].input;
+  mFrame = frame;
+  mFrameTick = frameTick;
+  return true;
+}
+
+KeyInput InputPlayer::getInput( bool leftHand, uint64_t tick ) const
+{
+  //recorded input already has handedness applied
+  while ( mOffset < mData.size() && mData[mOffset] == InputMovie::INPUT )
+  {
+    size_t offset = mOffset + 1;
+    uint64_t ticks;
+    readVarint( mData, offset, ticks );
+    if ( mFrameTick + ticks > tick )
+      break;
+    mInput = mData[offset] | ( mData[offset + 1] << 8 );
+    mOffset = offset + INPUT_SIZE;
+  }
+
+  return KeyInput{ mInput };
+}
+
+void InputPlayer::newFrame( uint64_t frame, uint64_t tick )
+{
+  //changes of previous frame are applied even if they were not read
+  getInput( false, std::numeric_limits<uint64_t>::max() );
+
+  if ( mOffset < mData.size() )
+  {
+    assert( mData[mOffset] == InputMovie::FRAME );
+    uint64_t ticks;
+    mOffset += 1;
+    readVarint( mData, mOffset, ticks );
+    mFrame += 1;
+  }
+
+  mFrameTick = tick;
+}
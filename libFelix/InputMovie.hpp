@@ -0,0 +1,92 @@
+#pragma once
+
+#include "IInputSource.hpp"
+
+//Recorded input of an emulation run.
+//The file is a header followed by records that are only ever appended, so it stays valid up to the last complete record.
+//A frame record marks the start of a frame, an input record a change of input at a tick offset from the start of its frame.
+//Input before the first frame record belongs to frame 0 that starts at power-on.
+namespace InputMovie
+{
+  static constexpr uint32_t MAGIC = 0x4d584c46; //"FLXM"
+  static constexpr uint32_t VERSION = 1;
+
+  enum Record : uint8_t
+  {
+    //varint ticks since start of previous frame
+    FRAME,
+    //varint ticks since start of frame, two bytes of input
+    INPUT
+  };
+
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t version;
+    //power-on seed of recorded run
+    uint64_t seed;
+  };
+}
+
+//Passes input of another source to emulation and records its changes.
+//Must be attached to a machine since power-on. Speculative emulation (rewind, run-ahead) is not allowed during recording.
+class InputRecorder : public IInputSource
+{
+public:
+  InputRecorder( std::shared_ptr<IInputSource> source, std::filesystem::path const& path, uint64_t seed );
+  ~InputRecorder() override;
+
+  bool good() const;
+
+  KeyInput getInput( bool leftHand, uint64_t tick ) const override;
+  void newFrame( uint64_t frame, uint64_t tick ) override;
+
+private:
+  std::shared_ptr<IInputSource> mSource;
+  std::ofstream mOut;
+  mutable std::vector<uint8_t> mBuffer;
+  mutable uint32_t mLast;
+  uint64_t mFrameTick;
+};
+
+//Replays recorded input on emulation thread without locking or host clock.
+class InputPlayer : public IInputSource
+{
+public:
+  //returns empty pointer if file is not a movie. Truncated last record is ignored
+  static std::shared_ptr<InputPlayer> load( std::filesystem::path const& path );
+
+  uint64_t seed() const;
+  //number of recorded frames including frame 0
+  uint64_t frames() const;
+  //frame being played and tick of its start
+  uint64_t frame() const;
+  uint64_t frameTick() const;
+  bool finished() const;
+
+  //continues playback from the start of given frame that began on given tick. Returns false if frame was not recorded
+  bool seek( uint64_t frame, uint64_t frameTick );
+
+  KeyInput getInput( bool leftHand, uint64_t tick ) const override;
+  void newFrame( uint64_t frame, uint64_t tick ) override;
+
+private:
+  struct FrameStart
+  {
+    //offset of first record of the frame
+    size_t offset;
+    //input at the start of the frame
+    uint32_t input;
+  };
+
+  InputPlayer( std::vector<uint8_t> data, uint64_t seed );
+
+private:
+  std::vector<uint8_t> mData;
+  std::vector<FrameStart> mFrames;
+  uint64_t mSeed;
+  mutable size_t mOffset;
+  mutable uint32_t mInput;
+  uint64_t mFrame;
+  uint64_t mFrameTick;
+};
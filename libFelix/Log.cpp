@@ -5,40 +5,100 @@
 #include <Windows.h>
 #endif
 
-Log::Log() : mLogLevel{ LL_INFO }
+std::atomic<Log::LogLevel> Log::sLogLevel{ LL_INFO };
+
+Log::Log() : mSlots{ std::make_unique<Slot[]>( RING_SIZE ) }, mEnqueuePos{}, mDequeuePos{}, mDropped{}, mFinished{}, mWriter{}
 {
+  for ( size_t i = 0; i < RING_SIZE; ++i )
+  {
+    mSlots[i].sequence.store( i, std::memory_order_relaxed );
+  }
+
+  mWriter = std::thread{ [this]
+  {
+    writer();
+  } };
+}
+
+Log::~Log()
+{
+  mFinished.store( true );
+  if ( mWriter.joinable() )
+    mWriter.join();
 }
 
 void Log::setLogLevel( LogLevel ll )
 {
-  mLogLevel = ll;
+  sLogLevel.store( ll, std::memory_order_relaxed );
+}
+
+void Log::log( LogLevel ll, std::string_view message )
+{
+  if ( !enabled( ll ) )
+    return;
+
+  //bounded multi-producer queue, producers claim slots by advancing enqueue position
+  size_t pos = mEnqueuePos.load( std::memory_order_relaxed );
+  Slot * slot;
+  for ( ;; )
+  {
+    slot = &mSlots[pos % RING_SIZE];
+    size_t sequence = slot->sequence.load( std::memory_order_acquire );
+    if ( sequence == pos )
+    {
+      if ( mEnqueuePos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+        break;
+    }
+    else if ( sequence < pos )
+    {
+      //full
+      mDropped.fetch_add( 1, std::memory_order_relaxed );
+      return;
+    }
+    else
+    {
+      pos = mEnqueuePos.load( std::memory_order_relaxed );
+    }
+  }
+
+  slot->size = (uint32_t)std::min( message.size(), MESSAGE_SIZE );
+  std::memcpy( slot->message, message.data(), slot->size );
+  slot->sequence.store( pos + 1, std::memory_order_release );
 }
 
-void Log::log( LogLevel ll, std::string const & message )
+void Log::writer()
 {
-  if ( ll >= mLogLevel )
+  std::string line;
+
+  for ( ;; )
   {
-    //static bool err = false;
-    //if ( ll >= LL_ERROR )
-    //{
-    //  if ( !err )
-    //  {
-    //    std::cout.flush();
-    //  }
-    //  std::cerr << message;
-    //  err = true;
-    //}
-    //else
-    //{
-    //  if ( err )
-    //  {
-    //    std::cerr.flush();
-    //  }
-    //  std::cout << message;
-    //  err = false;
-    //}
+    bool finished = mFinished.load();
+
+    Slot & slot = mSlots[mDequeuePos % RING_SIZE];
+    if ( slot.sequence.load( std::memory_order_acquire ) == mDequeuePos + 1 )
+    {
+      line.assign( slot.message, slot.size );
+      slot.sequence.store( mDequeuePos + RING_SIZE, std::memory_order_release );
+      mDequeuePos += 1;
+    }
+    else if ( size_t dropped = mDropped.exchange( 0, std::memory_order_relaxed ) )
+    {
+      line = fmt::format( "{} log messages dropped", dropped );
+    }
+    else if ( finished )
+    {
+      //everything logged before destruction is written
+      return;
+    }
+    else
+    {
+      std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+      continue;
+    }
+
+    line += '\n';
 #ifdef _WIN32
-    OutputDebugStringA( message.c_str() );
+    OutputDebugStringA( line.c_str() );
 #endif
   }
 }
@@ -49,12 +109,11 @@ Log & Log::instance()
   return instance;
 }
 
-Formatter::Formatter( Log::LogLevel ll ) : mLl{ ll }, mSS{}
+Formatter::Formatter( Log::LogLevel ll ) : mLl{ ll }, mBuffer{}
 {
 }
 
 Formatter::~Formatter()
 {
-  mSS << std::endl;
-  Log::instance().log( mLl, mSS.str() );
+  Log::instance().log( mLl, std::string_view{ mBuffer.data(), mBuffer.size() } );
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "fmt/format.h"
 
+//Messages are checked against the log level before anything is formatted, formatted with fmt
+//and passed through a lock-free ring to a writer thread, so logging costs nothing when off and little when on.
 class Log
 {
 public:
@@ -16,39 +19,79 @@ public:
 
   void setLogLevel( LogLevel ll );
 
-  void log( LogLevel ll, std::string const& message );
+  static bool enabled( LogLevel ll )
+  {
+    return ll >= sLogLevel.load( std::memory_order_relaxed );
+  }
+
+  //never blocks. Message is dropped if the writer thread falls behind, longer ones are truncated
+  void log( LogLevel ll, std::string_view message );
 
   static Log & instance();
 
 private:
   Log();
+  ~Log();
+
+  void writer();
+
+private:
+  static constexpr size_t RING_SIZE = 1024;
+  static constexpr size_t MESSAGE_SIZE = 500;
 
-  LogLevel mLogLevel;
+  struct Slot
+  {
+    //equal to enqueue position when free, one more when filled
+    std::atomic<size_t> sequence;
+    uint32_t size;
+    char message[MESSAGE_SIZE];
+  };
+
+  static std::atomic<LogLevel> sLogLevel;
+
+  std::unique_ptr<Slot[]> mSlots;
+  std::atomic<size_t> mEnqueuePos;
+  size_t mDequeuePos;
+  std::atomic<size_t> mDropped;
+  std::atomic_bool mFinished;
+  std::thread mWriter;
 };
 
 class Formatter
 {
 public:
-  Formatter( Log::LogLevel ll );
+  explicit Formatter( Log::LogLevel ll );
   ~Formatter();
 
   template<typename T>
   Formatter & operator<<( T const& t )
   {
-    mSS << t;
+    fmt::format_to( std::back_inserter( mBuffer ), "{}", t );
     return *this;
   }
 
 private:
   Log::LogLevel mLl;
-  std::stringstream mSS;
+  fmt::memory_buffer mBuffer;
 };
 
-#define L_TRACE ::Formatter{ ::Log::LL_TRACE }
-#define L_DEBUG ::Formatter{ ::Log::LL_DEBUG }
-#define L_INFO ::Formatter{ ::Log::LL_INFO }
-#define L_NOTICE ::Formatter{ ::Log::LL_NOTICE }
-#define L_WARNING ::Formatter{ ::Log::LL_WARNING }
-#define L_ERROR ::Formatter{ ::Log::LL_ERROR }
+//levels below are compiled out
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL ::Log::LL_DEBUG
+#else
+#define LOG_MIN_LEVEL ::Log::LL_TRACE
+#endif
+#endif
+
+//arguments are not evaluated unless the level is enabled. The else branches keep the macro safe inside unbraced if statements
+#define L_LOG( LL ) if constexpr ( ( LL ) < ( LOG_MIN_LEVEL ) ) {} else if ( !::Log::enabled( LL ) ) {} else ::Formatter{ LL }
+
+#define L_TRACE L_LOG( ::Log::LL_TRACE )
+#define L_DEBUG L_LOG( ::Log::LL_DEBUG )
+#define L_INFO L_LOG( ::Log::LL_INFO )
+#define L_NOTICE L_LOG( ::Log::LL_NOTICE )
+#define L_WARNING L_LOG( ::Log::LL_WARNING )
+#define L_ERROR L_LOG( ::Log::LL_ERROR )
 
 #define L_SET_LOGLEVEL(LL) ::Log::instance().setLogLevel( LL );
@@ -0,0 +1,212 @@
+#include "pch.hpp"
+#include "MemorySearch.hpp"
+#include <emmintrin.h>
+
+MemorySearch::MemorySearch() : mCandidates{}, mPrevious( 0x10000 + 1 ), mWidth{ Width::BYTE }, mStarted{}
+{
+}
+
+void MemorySearch::start( std::span<uint8_t const> ram, Width width )
+{
+  assert( ram.size() >= 0x10000 );
+
+  mWidth = width;
+  mStarted = true;
+  std::copy_n( ram.begin(), 0x10000, mPrevious.begin() );
+  mCandidates.fill( ~0ull );
+
+  switch ( width )
+  {
+  case Width::WORD:
+    //word would wrap around
+    remove( 0xffff );
+    break;
+  case Width::BCD_WORD:
+    remove( 0xffff );
+    [[fallthrough]];
+  case Width::BCD_BYTE:
+    for ( uint32_t address = 0; address < 0x10000; ++address )
+    {
+      if ( !value( mPrevious, (uint16_t)address, width ) )
+        remove( (uint16_t)address );
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void MemorySearch::refine( std::span<uint8_t const> ram, Predicate predicate, uint32_t operand )
+{
+  assert( ram.size() >= 0x10000 );
+
+  if ( !mStarted )
+    return;
+
+  if ( mWidth == Width::BYTE )
+    refineBytes( ram, predicate, (uint8_t)operand );
+  else
+    refineValues( ram, predicate, operand );
+
+  std::copy_n( ram.begin(), 0x10000, mPrevious.begin() );
+}
+
+void MemorySearch::remove( uint16_t address )
+{
+  mCandidates[address >> 6] &= ~( 1ull << ( address & 63 ) );
+}
+
+bool MemorySearch::started() const
+{
+  return mStarted;
+}
+
+MemorySearch::Width MemorySearch::width() const
+{
+  return mWidth;
+}
+
+size_t MemorySearch::count() const
+{
+  size_t result = 0;
+  for ( auto word : mCandidates )
+  {
+    result += std::popcount( word );
+  }
+  return result;
+}
+
+std::vector<uint16_t> MemorySearch::candidates( size_t limit ) const
+{
+  std::vector<uint16_t> result;
+  for ( size_t i = 0; i < WORDS && result.size() < limit; ++i )
+  {
+    for ( uint64_t word = mCandidates[i]; word != 0 && result.size() < limit; word &= word - 1 )
+    {
+      result.push_back( (uint16_t)( i * 64 + std::countr_zero( word ) ) );
+    }
+  }
+  return result;
+}
+
+std::optional<uint32_t> MemorySearch::previous( uint16_t address ) const
+{
+  return value( mPrevious, address, mWidth );
+}
+
+std::optional<uint32_t> MemorySearch::value( std::span<uint8_t const> ram, uint16_t address, Width width )
+{
+  auto bcd = []( uint8_t byte ) -> std::optional<uint32_t>
+  {
+    if ( ( byte & 0x0f ) > 9 || ( byte >> 4 ) > 9 )
+      return std::nullopt;
+    return ( byte >> 4 ) * 10 + ( byte & 0x0f );
+  };
+
+  switch ( width )
+  {
+  case Width::BYTE:
+    return ram[address];
+  case Width::WORD:
+    return ram[address] | ( ram[address + 1] << 8 );
+  case Width::BCD_BYTE:
+    return bcd( ram[address] );
+  default:
+    {
+      auto lo = bcd( ram[address] );
+      auto hi = bcd( ram[address + 1] );
+      if ( !lo || !hi )
+        return std::nullopt;
+      return *lo + *hi * 100;
+    }
+  }
+}
+
+bool MemorySearch::holds( Predicate predicate, uint32_t current, uint32_t previous, uint32_t operand, uint32_t modulo )
+{
+  switch ( predicate )
+  {
+  case Predicate::EQUAL:
+    return current == operand;
+  case Predicate::NOT_EQUAL:
+    return current != operand;
+  case Predicate::CHANGED:
+    return current != previous;
+  case Predicate::UNCHANGED:
+    return current == previous;
+  case Predicate::INCREASED:
+    return current > previous;
+  case Predicate::DECREASED:
+    return current < previous;
+  case Predicate::INCREASED_BY:
+    return ( current + modulo - previous ) % modulo == operand % modulo;
+  case Predicate::DECREASED_BY:
+    return ( previous + modulo - current ) % modulo == operand % modulo;
+  default:
+    return false;
+  }
+}
+
+void MemorySearch::refineBytes( std::span<uint8_t const> ram, Predicate predicate, uint8_t operand )
+{
+  __m128i const op = _mm_set1_epi8( (char)operand );
+
+  //bit of each byte of 16 for which predicate holds
+  auto compare = [&]( __m128i current, __m128i previous ) -> uint32_t
+  {
+    switch ( predicate )
+    {
+    case Predicate::EQUAL:
+      return _mm_movemask_epi8( _mm_cmpeq_epi8( current, op ) );
+    case Predicate::NOT_EQUAL:
+      return ~_mm_movemask_epi8( _mm_cmpeq_epi8( current, op ) ) & 0xffff;
+    case Predicate::CHANGED:
+      return ~_mm_movemask_epi8( _mm_cmpeq_epi8( current, previous ) ) & 0xffff;
+    case Predicate::UNCHANGED:
+      return _mm_movemask_epi8( _mm_cmpeq_epi8( current, previous ) );
+    case Predicate::INCREASED:
+      return ~_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_max_epu8( current, previous ), previous ) ) & 0xffff;
+    case Predicate::DECREASED:
+      return ~_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_min_epu8( current, previous ), previous ) ) & 0xffff;
+    case Predicate::INCREASED_BY:
+      return _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_sub_epi8( current, previous ), op ) );
+    case Predicate::DECREASED_BY:
+      return _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_sub_epi8( previous, current ), op ) );
+    default:
+      return 0;
+    }
+  };
+
+  for ( size_t i = 0; i < WORDS; ++i )
+  {
+    if ( mCandidates[i] == 0 )
+      continue;
+
+    uint64_t mask = 0;
+    for ( size_t j = 0; j < 4; ++j )
+    {
+      size_t offset = i * 64 + j * 16;
+      __m128i current = _mm_loadu_si128( (__m128i const*)( ram.data() + offset ) );
+      __m128i previous = _mm_loadu_si128( (__m128i const*)( mPrevious.data() + offset ) );
+      mask |= (uint64_t)compare( current, previous ) << ( j * 16 );
+    }
+    mCandidates[i] &= mask;
+  }
+}
+
+void MemorySearch::refineValues( std::span<uint8_t const> ram, Predicate predicate, uint32_t operand )
+{
+  uint32_t modulo = mWidth == Width::WORD ? 0x10000 : mWidth == Width::BCD_WORD ? 10000 : 100;
+
+  for ( size_t i = 0; i < WORDS; ++i )
+  {
+    for ( uint64_t word = mCandidates[i]; word != 0; word &= word - 1 )
+    {
+      auto address = (uint16_t)( i * 64 + std::countr_zero( word ) );
+      auto current = value( ram, address, mWidth );
+      auto previous = value( mPrevious, address, mWidth );
+      if ( !current || !previous || !holds( predicate, *current, *previous, operand, modulo ) )
+        remove( address );
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+//Narrows RAM down to addresses whose values follow a series of comparisons, as cheat finders do.
+//Candidates are a bitmap and each refinement compares a new snapshot of RAM with the previous one,
+//byte sized comparisons 16 addresses at a time.
+class MemorySearch
+{
+public:
+  enum class Width
+  {
+    BYTE,
+    //little endian
+    WORD,
+    //two decimal digits
+    BCD_BYTE,
+    //four decimal digits, little endian
+    BCD_WORD
+  };
+
+  enum class Predicate
+  {
+    EQUAL,
+    NOT_EQUAL,
+    CHANGED,
+    UNCHANGED,
+    INCREASED,
+    DECREASED,
+    INCREASED_BY,
+    DECREASED_BY
+  };
+
+  MemorySearch();
+
+  //every address is a candidate, ram is the first snapshot
+  void start( std::span<uint8_t const> ram, Width width );
+  //keeps candidates for which predicate holds between the previous snapshot and ram, which becomes the previous one.
+  //operand is the value compared with or the difference, in decimal for BCD widths
+  void refine( std::span<uint8_t const> ram, Predicate predicate, uint32_t operand = 0 );
+  void remove( uint16_t address );
+
+  bool started() const;
+  Width width() const;
+  size_t count() const;
+  //first candidates in address order
+  std::vector<uint16_t> candidates( size_t limit ) const;
+  //value at address in the previous snapshot, nullopt for invalid BCD
+  std::optional<uint32_t> previous( uint16_t address ) const;
+
+  static std::optional<uint32_t> value( std::span<uint8_t const> ram, uint16_t address, Width width );
+
+private:
+  static bool holds( Predicate predicate, uint32_t current, uint32_t previous, uint32_t operand, uint32_t modulo );
+  void refineBytes( std::span<uint8_t const> ram, Predicate predicate, uint8_t operand );
+  void refineValues( std::span<uint8_t const> ram, Predicate predicate, uint32_t operand );
+
+private:
+  static constexpr size_t WORDS = 0x10000 / 64;
+
+  std::array<uint64_t, WORDS> mCandidates;
+  //with room for the high byte of a word at the last address
+  std::vector<uint8_t> mPrevious;
+  Width mWidth;
+  bool mStarted;
+};
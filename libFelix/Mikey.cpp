@@ -7,6 +7,7 @@
 #include "CPU.hpp"
 #include "ComLynx.hpp"
 #include "VGMWriter.hpp"
+#include "Snapshot.hpp"
 
 Mikey::Mikey( Core & core, ComLynx & comLynx, std::shared_ptr<IVideoSink> videoSink ) : mCore{ core }, mComLynx{ comLynx }, mAccessTick{}, mTimers{}, mAudioChannels{}, mPalette{},
   mAttenuation{ 0xff, 0xff, 0xff, 0xff }, mAttenuationLeft{ 0x3c, 0x3c, 0x3c, 0x3c }, mAttenuationRight{ 0x3c, 0x3c, 0x3c, 0x3c }, mDisplayGenerator{ std::make_unique<DisplayGenerator>( std::move( videoSink ) ) },
@@ -484,6 +485,20 @@ void Mikey::setVGMWriter( std::shared_ptr<VGMWriter> writer )
   mVGMWriter = std::move( writer );
 }
 
+std::shared_ptr<VGMWriter> Mikey::vgmWriter() const
+{
+  return mVGMWriter;
+}
+
+void Mikey::muteVideo( bool muted )
+{
+  //palette changes were not sent while muted
+  bool unmuted = mDisplayGenerator->muted() && !muted;
+  mDisplayGenerator->mute( muted );
+  if ( unmuted )
+    mDisplayGenerator->resendPalette( mPalette );
+}
+
 void Mikey::setIRQ( uint8_t mask )
 {
   mIRQ |= mask;
@@ -514,3 +529,26 @@ std::span<uint8_t const, 32> Mikey::debugPalette() const
 {
   return std::span<uint8_t const, 32>( mPalette.data(), mPalette.size() );
 }
+
+void Mikey::serialize( Snapshot & snapshot )
+{
+  snapshot.section( "MIKY" );
+  snapshot( mAccessTick, mPalette, mAttenuation, mAttenuationLeft, mAttenuationRight, mDisplayRegs, mSuzyDone, mPan, mStereo, mSerDat, mIRQ );
+
+  for ( auto & timer : mTimers )
+  {
+    timer->serialize( snapshot );
+  }
+  for ( auto & channel : mAudioChannels )
+  {
+    channel->serialize( snapshot );
+  }
+
+  mParallelPort.serialize( snapshot );
+  mDisplayGenerator->serialize( snapshot );
+
+  if ( snapshot.loading() )
+  {
+    mDisplayGenerator->resendPalette( mPalette );
+  }
+}
@@ -10,6 +10,7 @@ class TimerCore;
 class AudioChannel;
 class DisplayGenerator;
 class VGMWriter;
+class Snapshot;
 
 class Mikey
 {
@@ -85,6 +86,10 @@ public:
   void suzyDone();
   AudioSample sampleAudio( uint64_t tick ) const;
   void setVGMWriter( std::shared_ptr<VGMWriter> writer );
+  std::shared_ptr<VGMWriter> vgmWriter() const;
+  //palette is resent on unmute as color register writes were not seen by the video sink
+  void muteVideo( bool muted );
+  void serialize( Snapshot & snapshot );
 
   void setIRQ( uint8_t mask );
   void resetIRQ( uint8_t mask );
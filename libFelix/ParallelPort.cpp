@@ -3,6 +3,7 @@
 #include "Cartridge.hpp"
 #include "ComLynx.hpp"
 #include "Core.hpp"
+#include "Snapshot.hpp"
 
 
 ParallelPort::ParallelPort( Core & core, ComLynx & comLynx, RestProvider const & restProvider ) : mCore{ core }, mComLynx{ comLynx }, mRestProvider{ restProvider },
@@ -83,3 +84,8 @@ uint8_t ParallelPort::getData( uint64_t tick ) const
 
   return result;
 }
+
+void ParallelPort::serialize( Snapshot & snapshot )
+{
+  snapshot( mOutputMask, mData );
+}
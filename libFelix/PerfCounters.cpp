@@ -0,0 +1,120 @@
+#include "pch.hpp"
+#include "PerfCounters.hpp"
+#include "Suzy.hpp"
+
+static_assert( PerfCounters::SUZY_REQUESTS == ISuzyProcess::Request::XOR + 1 );
+
+namespace
+{
+
+std::string_view actionName( size_t action )
+{
+  switch ( (Action)action )
+  {
+  case Action::DISPLAY_DMA:
+    return "display_dma";
+  case Action::FIRE_TIMER0:
+    return "fire_timer0";
+  case Action::FIRE_TIMER1:
+    return "fire_timer1";
+  case Action::FIRE_TIMER2:
+    return "fire_timer2";
+  case Action::FIRE_TIMER3:
+    return "fire_timer3";
+  case Action::FIRE_TIMER4:
+    return "fire_timer4";
+  case Action::FIRE_TIMER5:
+    return "fire_timer5";
+  case Action::FIRE_TIMER6:
+    return "fire_timer6";
+  case Action::FIRE_TIMER7:
+    return "fire_timer7";
+  case Action::FIRE_TIMER8:
+    return "fire_timer8";
+  case Action::FIRE_TIMER9:
+    return "fire_timer9";
+  case Action::FIRE_TIMERA:
+    return "fire_timera";
+  case Action::FIRE_TIMERB:
+    return "fire_timerb";
+  case Action::FIRE_TIMERC:
+    return "fire_timerc";
+  case Action::ASSERT_IRQ:
+    return "assert_irq";
+  case Action::ASSERT_RESET:
+    return "assert_reset";
+  case Action::DESERT_IRQ:
+    return "desert_irq";
+  case Action::DESERT_RESET:
+    return "desert_reset";
+  case Action::SAMPLE_AUDIO:
+    return "sample_audio";
+  case Action::BATCH_END:
+    return "batch_end";
+  default:
+    //erased actions are popped as NONE
+    return action == 0 ? "none" : "";
+  }
+}
+
+template<size_t N>
+void subtract( std::array<uint64_t, N> & left, std::array<uint64_t, N> const& right )
+{
+  for ( size_t i = 0; i < N; ++i )
+  {
+    left[i] -= right[i];
+  }
+}
+
+}
+
+PerfCounters PerfCounters::operator-( PerfCounters const& other ) const
+{
+  PerfCounters result = *this;
+  result.instructions -= other.instructions;
+  subtract( result.busCycles, other.busCycles );
+  subtract( result.pushes, other.pushes );
+  subtract( result.pops, other.pops );
+  subtract( result.resumes, other.resumes );
+  subtract( result.suzyRequests, other.suzyRequests );
+  result.displayDmaBursts -= other.displayDmaBursts;
+  result.audioSamples -= other.audioSamples;
+  subtract( result.nanoseconds, other.nanoseconds );
+  return result;
+}
+
+void PerfCounters::forEach( std::function<void( std::string_view name, uint64_t value )> const& fun ) const
+{
+  static constexpr std::array<std::string_view, (size_t)Region::END_> regions{ "ram", "suzy", "mikey", "rom" };
+  static constexpr std::array<std::string_view, (size_t)Coroutine::END_> coroutines{ "cpu", "suzy", "eeprom", "gamedrive" };
+  static constexpr std::array<std::string_view, SUZY_REQUESTS> suzyTypes{ "finish", "fetchscb", "read", "read4", "readpal", "write", "writefred", "colrmw", "vidrmw", "xor" };
+  static constexpr std::array<std::string_view, (size_t)Subsystem::END_> subsystems{ "cpu", "suzy", "mikey", "display", "audio" };
+
+  std::string name;
+  auto prefixed = [&]( std::string_view prefix, std::string_view suffix ) -> std::string_view
+  {
+    name.assign( prefix );
+    name.append( suffix );
+    return name;
+  };
+
+  fun( "instructions", instructions );
+  for ( size_t i = 0; i < busCycles.size(); ++i )
+    fun( prefixed( "cycles.", regions[i] ), busCycles[i] );
+  for ( size_t i = 0; i < ACTIONS; ++i )
+  {
+    if ( auto action = actionName( i ); !action.empty() )
+    {
+      fun( prefixed( "push.", action ), pushes[i] );
+      fun( prefixed( "pop.", action ), pops[i] );
+    }
+  }
+  for ( size_t i = 0; i < resumes.size(); ++i )
+    fun( prefixed( "resume.", coroutines[i] ), resumes[i] );
+  for ( size_t i = 0; i < suzyRequests.size(); ++i )
+    fun( prefixed( "suzy.", suzyTypes[i] ), suzyRequests[i] );
+  fun( "display_dma", displayDmaBursts );
+  fun( "audio_samples", audioSamples );
+  for ( size_t i = 0; i < nanoseconds.size(); ++i )
+    fun( prefixed( "ns.", subsystems[i] ), nanoseconds[i] );
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "ActionQueue.hpp"
+#include "Utility.hpp"
+
+//Host side counts of emulator work, to tell which subsystem dominates a title.
+//Counted only when built with FELIX_PERF_COUNTERS defined, otherwise counters stay zero and counting compiles to nothing.
+#ifdef FELIX_PERF_COUNTERS
+static constexpr bool ENABLE_PERF_COUNTERS = true;
+#else
+static constexpr bool ENABLE_PERF_COUNTERS = false;
+#endif
+
+struct PerfCounters
+{
+  //in page type order
+  enum class Region
+  {
+    RAM,
+    SUZY,
+    MIKEY,
+    ROM,
+    END_
+  };
+
+  enum class Coroutine
+  {
+    CPU,
+    SUZY,
+    EEPROM,
+    GAMEDRIVE,
+    END_
+  };
+
+  enum class Subsystem
+  {
+    CPU,
+    SUZY,
+    //timers and interrupts
+    MIKEY,
+    DISPLAY,
+    AUDIO,
+    END_
+  };
+
+  static constexpr size_t ACTIONS = (size_t)Action::ACTIONS_END_;
+  static constexpr size_t SUZY_REQUESTS = 10;
+
+  uint64_t instructions;
+  std::array<uint64_t, (size_t)Region::END_> busCycles;
+  std::array<uint64_t, ACTIONS> pushes;
+  std::array<uint64_t, ACTIONS> pops;
+  std::array<uint64_t, (size_t)Coroutine::END_> resumes;
+  std::array<uint64_t, SUZY_REQUESTS> suzyRequests;
+  uint64_t displayDmaBursts;
+  uint64_t audioSamples;
+  std::array<uint64_t, (size_t)Subsystem::END_> nanoseconds;
+
+  //counts accumulated since other was taken
+  PerfCounters operator-( PerfCounters const& other ) const;
+
+  //calls fun with dotted name and value of each counter, e.g. "cycles.ram"
+  void forEach( std::function<void( std::string_view name, uint64_t value )> const& fun ) const;
+};
+
+inline void perfCount( uint64_t & counter, uint64_t value = 1 )
+{
+  if constexpr ( ENABLE_PERF_COUNTERS )
+    counter += value;
+}
+
+//Adds host time spent in its scope to a counter
+class PerfTimer : private NonCopyable
+{
+public:
+  explicit PerfTimer( uint64_t & nanoseconds ) : mNanoseconds{ nanoseconds }, mBegin{}
+  {
+    if constexpr ( ENABLE_PERF_COUNTERS )
+      mBegin = std::chrono::steady_clock::now();
+  }
+
+  ~PerfTimer()
+  {
+    if constexpr ( ENABLE_PERF_COUNTERS )
+      mNanoseconds += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - mBegin ).count();
+  }
+
+private:
+  uint64_t & mNanoseconds;
+  std::chrono::steady_clock::time_point mBegin;
+};
@@ -0,0 +1,137 @@
+#include "pch.hpp"
+#include "Profiler.hpp"
+#include "SymbolSource.hpp"
+
+Profiler::Profiler( uint64_t const& tick ) : mTick{ tick }, mLastTick{ tick }, mNodes{}, mStack{}, mTimeline{}
+{
+  //root holds code outside of any known call
+  mNodes.push_back( Node{ NONE, NONE, NONE, 0, false, 0, 0, 0 } );
+  mStack.push_back( Frame{ 0, 0 } );
+}
+
+void Profiler::updateStack( CPUState const& before, CPUState const& after )
+{
+  switch ( after.op )
+  {
+  case Opcode::JSA_JSR:
+    call( after.pc, after.sl, false );
+    break;
+  case Opcode::BRK_BRK:
+    if ( after.interrupt & CPUState::I_RESET )
+    {
+      mStack.resize( 1 );
+    }
+    //BRK treated as NOP pushes nothing
+    else if ( (uint8_t)( before.sl - 3 ) == after.sl )
+    {
+      call( after.pc, after.sl, after.interrupt != 0 );
+    }
+    break;
+  default:
+    //returning drops every frame above the stack pointer
+    while ( mStack.size() > 1 && mStack.back().sp < after.sl )
+    {
+      mStack.pop_back();
+    }
+    break;
+  }
+}
+
+void Profiler::call( uint16_t address, uint8_t sp, bool interrupt )
+{
+  if ( mStack.size() >= MAX_DEPTH )
+    return;
+
+  uint32_t parent = mStack.back().node;
+  uint32_t node = mNodes[parent].firstChild;
+  while ( node != NONE && ( mNodes[node].address != address || mNodes[node].interrupt != interrupt ) )
+  {
+    node = mNodes[node].nextSibling;
+  }
+
+  if ( node == NONE )
+  {
+    node = (uint32_t)mNodes.size();
+    mNodes.push_back( Node{ parent, NONE, mNodes[parent].firstChild, address, interrupt, 0, 0, 0 } );
+    mNodes[parent].firstChild = node;
+  }
+
+  mNodes[node].calls += 1;
+  mStack.push_back( Frame{ node, sp } );
+}
+
+void Profiler::newFrame( uint64_t frame )
+{
+  size_t begin = mTimeline.size();
+
+  for ( uint32_t i = 0; i < mNodes.size(); ++i )
+  {
+    auto & node = mNodes[i];
+    if ( node.frameTicks == 0 )
+      continue;
+
+    //function called from several places is one entry
+    auto it = std::find_if( mTimeline.begin() + begin, mTimeline.end(), [&]( TimelineEntry const& entry )
+    {
+      return sameFunction( mNodes[entry.node], node );
+    } );
+    if ( it == mTimeline.end() )
+      mTimeline.push_back( TimelineEntry{ frame, node.frameTicks, i } );
+    else
+      it->ticks += node.frameTicks;
+
+    node.frameTicks = 0;
+  }
+}
+
+bool Profiler::write( std::filesystem::path const& path, SymbolSource const* symbols ) const
+{
+  std::ofstream folded{ path };
+  std::ofstream timeline{ std::filesystem::path{ path }.concat( ".timeline.csv" ) };
+  if ( !folded || !timeline )
+    return false;
+
+  std::vector<std::string> names;
+  names.reserve( mNodes.size() );
+  for ( auto const& node : mNodes )
+  {
+    names.push_back( name( node, symbols ) );
+  }
+
+  //parents precede children
+  std::vector<std::string> stacks( mNodes.size() );
+  for ( size_t i = 0; i < mNodes.size(); ++i )
+  {
+    auto const& node = mNodes[i];
+    stacks[i] = node.parent == NONE ? names[i] : stacks[node.parent] + ';' + names[i];
+    if ( node.ticks )
+      folded << fmt::format( "{} {}\n", stacks[i], node.ticks );
+  }
+
+  timeline << "frame,function,ticks\n";
+  for ( auto const& entry : mTimeline )
+  {
+    timeline << fmt::format( "{},{},{}\n", entry.frame, names[entry.node], entry.ticks );
+  }
+
+  return folded.good() && timeline.good();
+}
+
+bool Profiler::sameFunction( Node const& left, Node const& right ) const
+{
+  return left.address == right.address && left.interrupt == right.interrupt && ( left.parent == NONE ) == ( right.parent == NONE );
+}
+
+std::string Profiler::name( Node const& node, SymbolSource const* symbols ) const
+{
+  if ( node.parent == NONE )
+    return "root";
+
+  std::string result;
+  if ( auto label = symbols ? symbols->label( node.address ) : std::nullopt )
+    result = *label;
+  else
+    result = fmt::format( "${:04x}", node.address );
+
+  return node.interrupt ? result + " (interrupt)" : result;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CPUState.hpp"
+
+class SymbolSource;
+
+//Attributes emulated ticks to guest code.
+//Ticks elapsed since the previous instruction, wait states, DMA, Suzy and CPU sleep included, are charged to the
+//function on top of a shadow call stack kept from JSR, BRK, interrupts, RTS and RTI.
+//Stack frames are matched by stack pointer, so code that drops return addresses does not unbalance the stack.
+class Profiler
+{
+public:
+  //tick is read at the end of each instruction
+  explicit Profiler( uint64_t const& tick );
+
+  void retire( CPUState const& before, CPUState const& after )
+  {
+    uint64_t tick = mTick;
+    //tick goes back when a state is restored
+    uint64_t elapsed = tick > mLastTick ? tick - mLastTick : 0;
+    mLastTick = tick;
+
+    auto & node = mNodes[mStack.back().node];
+    node.ticks += elapsed;
+    node.frameTicks += elapsed;
+
+    switch ( after.op )
+    {
+    case Opcode::JSA_JSR:
+    case Opcode::BRK_BRK:
+    case Opcode::RTS_RTS:
+    case Opcode::RTI_RTI:
+      updateStack( before, after );
+      break;
+    default:
+      break;
+    }
+  }
+
+  //closes timeline entry of the frame
+  void newFrame( uint64_t frame );
+
+  //writes folded stacks for flame graph tools to path and per frame ticks of functions to path.timeline.csv
+  bool write( std::filesystem::path const& path, SymbolSource const* symbols ) const;
+
+private:
+  static constexpr uint32_t NONE = ~0u;
+  static constexpr size_t MAX_DEPTH = 256;
+
+  struct Node
+  {
+    uint32_t parent;
+    uint32_t firstChild;
+    uint32_t nextSibling;
+    uint16_t address;
+    bool interrupt;
+    uint64_t calls;
+    //ticks spent in the function itself
+    uint64_t ticks;
+    uint64_t frameTicks;
+  };
+
+  struct Frame
+  {
+    uint32_t node;
+    //stack pointer after the call
+    uint8_t sp;
+  };
+
+  struct TimelineEntry
+  {
+    uint64_t frame;
+    uint64_t ticks;
+    //any node of the function
+    uint32_t node;
+  };
+
+  void updateStack( CPUState const& before, CPUState const& after );
+  void call( uint16_t address, uint8_t sp, bool interrupt );
+  bool sameFunction( Node const& left, Node const& right ) const;
+  std::string name( Node const& node, SymbolSource const* symbols ) const;
+
+private:
+  uint64_t const& mTick;
+  uint64_t mLastTick;
+  std::vector<Node> mNodes;
+  std::vector<Frame> mStack;
+  std::vector<TimelineEntry> mTimeline;
+};
@@ -0,0 +1,53 @@
+#include "pch.hpp"
+#include "RamFreeze.hpp"
+
+RamFreeze::RamFreeze() : mBitmap{}, mValues{}, mPending{}
+{
+}
+
+void RamFreeze::freeze( uint16_t address, uint8_t value )
+{
+  mValues[address].store( value, std::memory_order_relaxed );
+  mBitmap[address >> 6].fetch_or( 1ull << ( address & 63 ), std::memory_order_release );
+  mPending.store( true, std::memory_order_release );
+}
+
+void RamFreeze::thaw( uint16_t address )
+{
+  mBitmap[address >> 6].fetch_and( ~( 1ull << ( address & 63 ) ), std::memory_order_release );
+}
+
+void RamFreeze::clear()
+{
+  for ( auto & word : mBitmap )
+  {
+    word.store( 0, std::memory_order_release );
+  }
+}
+
+std::optional<uint8_t> RamFreeze::frozen( uint16_t address ) const
+{
+  if ( mBitmap[address >> 6].load( std::memory_order_acquire ) & ( 1ull << ( address & 63 ) ) )
+    return mValues[address].load( std::memory_order_relaxed );
+  else
+    return std::nullopt;
+}
+
+std::vector<std::pair<uint16_t, uint8_t>> RamFreeze::freezes() const
+{
+  std::vector<std::pair<uint16_t, uint8_t>> result;
+  for ( size_t i = 0; i < mBitmap.size(); ++i )
+  {
+    for ( uint64_t word = mBitmap[i].load( std::memory_order_acquire ); word != 0; word &= word - 1 )
+    {
+      auto address = (uint16_t)( i * 64 + std::countr_zero( word ) );
+      result.emplace_back( address, mValues[address].load( std::memory_order_relaxed ) );
+    }
+  }
+  return result;
+}
+
+void RamFreeze::invalidate()
+{
+  mPending.store( true, std::memory_order_release );
+}
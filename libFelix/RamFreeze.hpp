@@ -0,0 +1,38 @@
+#pragma once
+
+//Holds RAM bytes at fixed values.
+//CPU and Suzy writes to a frozen byte are replaced with its value, so a game never sees another one.
+//Freezes can be changed from any thread, values of new ones are stored to RAM by emulation thread.
+class RamFreeze
+{
+public:
+  RamFreeze();
+
+  void freeze( uint16_t address, uint8_t value );
+  void thaw( uint16_t address );
+  void clear();
+  std::optional<uint8_t> frozen( uint16_t address ) const;
+  std::vector<std::pair<uint16_t, uint8_t>> freezes() const;
+
+  uint8_t write( uint16_t address, uint8_t value ) const
+  {
+    if ( mBitmap[address >> 6].load( std::memory_order_acquire ) & ( 1ull << ( address & 63 ) ) )
+      return mValues[address].load( std::memory_order_relaxed );
+    else
+      return value;
+  }
+
+  //values of frozen bytes are to be stored to RAM again, e.g. when state is restored
+  void invalidate();
+
+  //true once after freezes were made or invalidated
+  bool takePending()
+  {
+    return mPending.load( std::memory_order_relaxed ) && mPending.exchange( false, std::memory_order_acquire );
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, 65536 / 64> mBitmap;
+  std::array<std::atomic<uint8_t>, 65536> mValues;
+  std::atomic_bool mPending;
+};
@@ -0,0 +1,231 @@
+#include "pch.hpp"
+#include "Rewind.hpp"
+#include "Core.hpp"
+
+namespace
+{
+
+void writeVarint( std::vector<uint8_t> & out, size_t value )
+{
+  while ( value >= 0x80 )
+  {
+    out.push_back( (uint8_t)( value | 0x80 ) );
+    value >>= 7;
+  }
+  out.push_back( (uint8_t)value );
+}
+
+size_t readVarint( uint8_t const*& src )
+{
+  size_t value = 0;
+  for ( int shift = 0;; shift += 7 )
+  {
+    uint8_t byte = *src++;
+    value |= (size_t)( byte & 0x7f ) << shift;
+    if ( ( byte & 0x80 ) == 0 )
+      return value;
+  }
+}
+
+size_t skipEqual( uint8_t const* a, uint8_t const* b, size_t i, size_t size )
+{
+  for ( ; i + sizeof( uint64_t ) <= size; i += sizeof( uint64_t ) )
+  {
+    uint64_t wa, wb;
+    std::memcpy( &wa, a + i, sizeof( wa ) );
+    std::memcpy( &wb, b + i, sizeof( wb ) );
+    if ( wa != wb )
+      break;
+  }
+  while ( i < size && a[i] == b[i] )
+    ++i;
+  return i;
+}
+
+uint64_t average( std::atomic<uint64_t> const& avg, uint64_t value )
+{
+  auto old = avg.load( std::memory_order_relaxed );
+  return old ? ( old * 15 + value ) / 16 : value;
+}
+
+}
+
+Rewind::Rewind( size_t budgetBytes ) : mRing( budgetBytes ), mEntries{}, mHead{}, mCurrent{}, mDelta{}, mEntriesBytes{}, mHeadTick{},
+  mStates{}, mUsedBytes{}, mTicks{}, mCaptureNanoseconds{}, mStepBackNanoseconds{}
+{
+}
+
+bool Rewind::capture( Core & core )
+{
+  auto begin = std::chrono::steady_clock::now();
+
+  if ( !core.snapshot( mCurrent ) )
+    return false;
+
+  if ( !mHead.empty() )
+  {
+    encode( mHead, mCurrent );
+    push( mHeadTick );
+  }
+
+  std::swap( mHead, mCurrent );
+  mHeadTick = core.tick();
+
+  auto ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - begin ).count();
+  mCaptureNanoseconds.store( average( mCaptureNanoseconds, ns ), std::memory_order_relaxed );
+  updateStats();
+  return true;
+}
+
+bool Rewind::stepBack( Core & core )
+{
+  if ( mEntries.empty() )
+    return false;
+
+  auto begin = std::chrono::steady_clock::now();
+
+  Entry entry = mEntries.back();
+  mEntries.pop_back();
+  mEntriesBytes -= entry.size;
+
+  decode( entry );
+  mHeadTick = entry.tick;
+  bool result = core.restore( mHead );
+
+  auto ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - begin ).count();
+  mStepBackNanoseconds.store( average( mStepBackNanoseconds, ns ), std::memory_order_relaxed );
+  updateStats();
+  return result;
+}
+
+void Rewind::clear()
+{
+  if ( mHead.empty() )
+    return;
+
+  mEntries.clear();
+  mEntriesBytes = 0;
+  mHead.clear();
+  mHeadTick = 0;
+  updateStats();
+}
+
+Rewind::Stats Rewind::stats() const
+{
+  return Stats{
+    mStates.load( std::memory_order_relaxed ),
+    mUsedBytes.load( std::memory_order_relaxed ),
+    mRing.size(),
+    mTicks.load( std::memory_order_relaxed ),
+    mCaptureNanoseconds.load( std::memory_order_relaxed ),
+    mStepBackNanoseconds.load( std::memory_order_relaxed )
+  };
+}
+
+//delta is the previous size followed by tokens of zero run length, literal length and literal bytes of prev XOR cur
+void Rewind::encode( std::vector<uint8_t> & prev, std::vector<uint8_t> & cur )
+{
+  uint32_t prevSize = (uint32_t)prev.size();
+  size_t curSize = cur.size();
+  size_t size = std::max( prev.size(), cur.size() );
+  prev.resize( size );
+  cur.resize( size );
+
+  mDelta.resize( sizeof( prevSize ) );
+  std::memcpy( mDelta.data(), &prevSize, sizeof( prevSize ) );
+
+  uint8_t const* a = prev.data();
+  uint8_t const* b = cur.data();
+
+  size_t i = 0;
+  for ( ;; )
+  {
+    size_t zeroBegin = i;
+    i = skipEqual( a, b, i, size );
+    if ( i == size )
+      break;
+
+    size_t literalBegin = i;
+    size_t equal = 0;
+    while ( i < size && equal < MIN_ZERO_RUN )
+    {
+      equal = a[i] == b[i] ? equal + 1 : 0;
+      ++i;
+    }
+    if ( equal == MIN_ZERO_RUN )
+      i -= MIN_ZERO_RUN;
+
+    writeVarint( mDelta, literalBegin - zeroBegin );
+    writeVarint( mDelta, i - literalBegin );
+    for ( size_t j = literalBegin; j < i; ++j )
+      mDelta.push_back( a[j] ^ b[j] );
+  }
+
+  cur.resize( curSize );
+}
+
+void Rewind::decode( Entry const& entry )
+{
+  uint8_t const* src = mRing.data() + entry.offset;
+  uint8_t const* end = src + entry.size;
+
+  uint32_t prevSize;
+  std::memcpy( &prevSize, src, sizeof( prevSize ) );
+  src += sizeof( prevSize );
+
+  mHead.resize( std::max<size_t>( prevSize, mHead.size() ) );
+  uint8_t* dst = mHead.data();
+
+  while ( src < end )
+  {
+    dst += readVarint( src );
+    size_t literal = readVarint( src );
+    assert( dst + literal <= mHead.data() + mHead.size() );
+    for ( size_t j = 0; j < literal; ++j )
+      *dst++ ^= *src++;
+  }
+
+  mHead.resize( prevSize );
+}
+
+void Rewind::push( uint64_t tick )
+{
+  size_t size = mDelta.size();
+  if ( size > mRing.size() )
+  {
+    //history can't be continued past a state that does not fit
+    mEntries.clear();
+    mEntriesBytes = 0;
+    return;
+  }
+
+  size_t offset = mEntries.empty() ? 0 : mEntries.back().offset + mEntries.back().size;
+  if ( offset + size > mRing.size() )
+  {
+    //the oldest entries lie past the write position, drop them so that only the start of the ring is in the way
+    while ( !mEntries.empty() && mEntries.front().offset >= offset )
+    {
+      mEntriesBytes -= mEntries.front().size;
+      mEntries.pop_front();
+    }
+    offset = 0;
+  }
+
+  //entries are laid out in ring order, so only the oldest ones can be in the way
+  while ( !mEntries.empty() && mEntries.front().offset < offset + size && mEntries.front().offset + mEntries.front().size > offset )
+  {
+    mEntriesBytes -= mEntries.front().size;
+    mEntries.pop_front();
+  }
+
+  std::memcpy( mRing.data() + offset, mDelta.data(), size );
+  mEntries.push_back( Entry{ offset, size, tick } );
+  mEntriesBytes += size;
+}
+
+void Rewind::updateStats()
+{
+  mStates.store( mEntries.size(), std::memory_order_relaxed );
+  mUsedBytes.store( mEntriesBytes + mHead.size(), std::memory_order_relaxed );
+  mTicks.store( mEntries.empty() ? 0 : mHeadTick - mEntries.front().tick, std::memory_order_relaxed );
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+class Core;
+
+//History of machine states for stepping emulation backwards within a fixed memory budget.
+//The newest state is kept whole. Every older one is stored as the XOR difference against its successor,
+//compressed by zero run length encoding, in a byte ring that evicts the oldest entries.
+class Rewind
+{
+public:
+  struct Stats
+  {
+    size_t states;
+    size_t usedBytes;
+    size_t budgetBytes;
+    //emulated time covered by the history
+    uint64_t ticks;
+    //running averages
+    uint64_t captureNanoseconds;
+    uint64_t stepBackNanoseconds;
+  };
+
+  explicit Rewind( size_t budgetBytes );
+
+  //returns false if core is not at a snapshot boundary
+  bool capture( Core & core );
+  //restores the state captured before the newest one and makes it the newest. Returns false if there is no such state
+  bool stepBack( Core & core );
+  void clear();
+
+  //safe to call from any thread
+  Stats stats() const;
+
+private:
+  struct Entry
+  {
+    size_t offset;
+    size_t size;
+    //tick of the state this entry reconstructs
+    uint64_t tick;
+  };
+
+  void encode( std::vector<uint8_t> & prev, std::vector<uint8_t> & cur );
+  void decode( Entry const& entry );
+  void push( uint64_t tick );
+  void updateStats();
+
+private:
+  //zero runs shorter than this are kept inside literals
+  static constexpr size_t MIN_ZERO_RUN = 4;
+
+  std::vector<uint8_t> mRing;
+  std::deque<Entry> mEntries;
+  std::vector<uint8_t> mHead;
+  std::vector<uint8_t> mCurrent;
+  std::vector<uint8_t> mDelta;
+  size_t mEntriesBytes;
+  uint64_t mHeadTick;
+
+  std::atomic<size_t> mStates;
+  std::atomic<size_t> mUsedBytes;
+  std::atomic<uint64_t> mTicks;
+  std::atomic<uint64_t> mCaptureNanoseconds;
+  std::atomic<uint64_t> mStepBackNanoseconds;
+};
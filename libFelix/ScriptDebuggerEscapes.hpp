@@ -21,6 +21,11 @@ public:
     mEscapes.push_back( { std::move( trap ), type, address } );
   }
 
+  bool empty() const
+  {
+    return mEscapes.empty();
+  }
+
   void populateScriptDebugger( ScriptDebugger& scriptDebugger ) const
   {
     for ( auto& esc : mEscapes )
@@ -0,0 +1,77 @@
+#include "pch.hpp"
+#include "Snapshot.hpp"
+
+Snapshot::Snapshot( std::vector<uint8_t> & out ) : mOut{ &out }, mIn{}, mOffset{}, mGood{ true }, mVerifying{}
+{
+  out.clear();
+  uint32_t magic = MAGIC;
+  uint32_t version = VERSION;
+  ( *this )( magic, version );
+}
+
+Snapshot::Snapshot( std::span<uint8_t const> in, bool verifying ) : mOut{}, mIn{ in }, mOffset{}, mGood{ true }, mVerifying{ verifying }
+{
+  uint32_t magic{};
+  uint32_t version{};
+  read( &magic, sizeof( magic ) );
+  read( &version, sizeof( version ) );
+  mGood = mGood && magic == MAGIC && version == VERSION;
+}
+
+bool Snapshot::saving() const
+{
+  return mOut != nullptr;
+}
+
+bool Snapshot::loading() const
+{
+  return mOut == nullptr && !mVerifying;
+}
+
+bool Snapshot::good() const
+{
+  return mGood;
+}
+
+void Snapshot::section( char const ( &tag )[5] )
+{
+  uint32_t value;
+  std::memcpy( &value, tag, sizeof( value ) );
+  uint32_t stored = value;
+  if ( saving() )
+    bytes( &stored, sizeof( stored ) );
+  else
+    read( &stored, sizeof( stored ) );
+  mGood = mGood && stored == value;
+}
+
+void Snapshot::bytes( void * data, size_t size )
+{
+  if ( mOut )
+  {
+    auto src = (uint8_t const*)data;
+    mOut->insert( mOut->end(), src, src + size );
+  }
+  else if ( mVerifying )
+  {
+    mGood = mGood && size <= mIn.size() - mOffset;
+    mOffset += mGood ? size : 0;
+  }
+  else
+  {
+    read( data, size );
+  }
+}
+
+void Snapshot::read( void * data, size_t size )
+{
+  if ( mGood && size <= mIn.size() - mOffset )
+  {
+    std::memcpy( data, mIn.data() + mOffset, size );
+    mOffset += size;
+  }
+  else
+  {
+    mGood = false;
+  }
+}
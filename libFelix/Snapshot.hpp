@@ -0,0 +1,66 @@
+#pragma once
+
+//Binary image of the machine state.
+//Every component has one serialize( Snapshot & ) member that is used both for saving and loading,
+//so the order of fields is defined in one place only.
+class Snapshot
+{
+public:
+  static constexpr uint32_t MAGIC = 0x53584c46; //"FLXS"
+  //increment on any change to serialized layout
+  static constexpr uint32_t VERSION = 3;
+
+  //saving. Previous content of out is discarded, its capacity is reused
+  explicit Snapshot( std::vector<uint8_t> & out );
+  //loading. Verifying reads in through without changing any value, to check it before anything is loaded
+  explicit Snapshot( std::span<uint8_t const> in, bool verifying = false );
+
+  bool saving() const;
+  //values are changed, i.e. not saving nor verifying
+  bool loading() const;
+  //false if loaded data was truncated or malformed
+  bool good() const;
+
+  //four character tag that separates components to catch layout mismatches early
+  void section( char const ( &tag )[5] );
+  void bytes( void * data, size_t size );
+
+  template<typename... T> requires ( std::is_trivially_copyable_v<T> && ... )
+  void operator()( T &... values )
+  {
+    ( bytes( &values, sizeof( T ) ), ... );
+  }
+
+  template<typename T> requires std::is_trivially_copyable_v<T>
+  void operator()( std::vector<T> & values )
+  {
+    uint32_t size = (uint32_t)values.size();
+    if ( saving() )
+    {
+      bytes( &size, sizeof( size ) );
+    }
+    else
+    {
+      read( &size, sizeof( size ) );
+      if ( !good() || size * sizeof( T ) > mIn.size() - mOffset )
+      {
+        mGood = false;
+        return;
+      }
+      if ( loading() )
+        values.resize( size );
+    }
+    bytes( values.data(), size * sizeof( T ) );
+  }
+
+private:
+  //reads even when verifying, for values the layout depends on
+  void read( void * data, size_t size );
+
+private:
+  std::vector<uint8_t> * mOut;
+  std::span<uint8_t const> mIn;
+  size_t mOffset;
+  bool mGood;
+  bool mVerifying;
+};
@@ -4,11 +4,12 @@
 #include "SuzyProcess.hpp"
 #include "Cartridge.hpp"
 #include "Log.hpp"
+#include "Snapshot.hpp"
 
-Suzy::Suzy( Core & core, std::shared_ptr<IInputSource> inputSource ) : mCore{ core }, mSCB{}, mMath{ mCore.getTraceHelper() }, mInputSource{ inputSource }, mAccessTick{},
+Suzy::Suzy( Core & core, std::shared_ptr<IInputSource> inputSource, uint64_t seed ) : mCore{ core }, mSCB{}, mMath{ mCore.getTraceHelper() }, mInputSource{ inputSource }, mAccessTick{},
   mPalette{}, mBusEnable{}, mNoCollide{}, mVStretch{}, mLeftHand{ true }, mUnsafeAccess{}, mSpriteStop{},
   mSpriteWorking{}, mHFlip{}, mVFlip{}, mLiteral{}, mAlgo3{}, mReusePalette{}, mSkipSprite{}, mStartingQuadrant{}, mEveron{},
-  mBpp{}, mSpriteType{}, mReload{}, mSprColl{}, mSprInit{}
+  mBpp{}, mSpriteType{}, mReload{}, mSprColl{}, mSprInit{}, mNoiceSeed{ seed }, mInput{}
 {
 }
 
@@ -177,13 +178,10 @@ uint8_t Suzy::read( uint16_t address )
       ( mSpriteWorking ? SPRSYS::SPRITEWORKING : 0 );
     break;
   case JOYSTICK:
-  {
-    uint8_t joystick = mInputSource->getInput( mLeftHand != 0 ).joystick();
-    return joystick;
-  }
+    return mInput.joystick();
   case SWITCHES:
   {
-    uint8_t switches = mInputSource->getInput( mLeftHand != 0 ).switches() |
+    uint8_t switches = mInput.switches() |
       ( mCore.getCartridge().isCart0Inactive() ? SWITCHES::CART0_STROBE : 0 ) |
       ( mCore.getCartridge().isCart1Inactive() ? SWITCHES::CART1_STROBE : 0 );
     return switches;
@@ -195,7 +193,7 @@ uint8_t Suzy::read( uint16_t address )
     //incrementing counter...
     mCore.getCartridge().peekRCART1( mAccessTick );
     //... but looks like mirror of joystick
-    return mInputSource->getInput( mLeftHand != 0 ).joystick();
+    return mInput.joystick();
   }
   default:
     if ( address < 0x80 )
@@ -421,7 +419,12 @@ void Suzy::write( uint16_t address, uint8_t value )
       mMath.accumulate( ( SPRSYS::ACCUMULATE & value ) != 0 );
       mNoCollide = ( SPRSYS::NO_COLLIDE & value ) != 0;
       mVStretch = ( SPRSYS::VSTRETCH & value ) != 0;
-      mLeftHand = ( SPRSYS::LEFTHAND & value ) != 0;
+      if ( mLeftHand != ( ( SPRSYS::LEFTHAND & value ) != 0 ) )
+      {
+        mLeftHand = ( SPRSYS::LEFTHAND & value ) != 0;
+        //directions are swapped by the source
+        latchInput( mAccessTick );
+      }
       mMath.unsafeAccess( mMath.unsafeAccess() && ( SPRSYS::UNSAFEACCESSRST & value ) == 0 );
       mSpriteStop = ( SPRSYS::SPRITESTOP & value ) != 0;
       break;
@@ -447,6 +450,11 @@ uint16_t Suzy::debugCollBas() const
   return mSCB.collbas;
 }
 
+void Suzy::latchInput( uint64_t tick )
+{
+  mInput = mInputSource->getInput( mLeftHand != 0, tick );
+}
+
 void Suzy::writeSPRCTL0( uint8_t value )
 {
   mBpp = (BPP)( value & SPRCTL0::BITS_MASK );
@@ -478,7 +486,11 @@ int Suzy::bpp() const
 uint8_t Suzy::noice( uint64_t tick )
 {
   //undefined registers (with address > $FC80) has some peculiar random noice characteristics that looks something like this
-  auto v = std::hash<uint64_t>()( tick ) & 0xffff;
+  //splitmix64 finalizer instead of std::hash, which is implementation defined and the identity in some standard libraries
+  uint64_t z = tick + mNoiceSeed;
+  z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+  z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebull;
+  auto v = ( z ^ ( z >> 31 ) ) & 0xffff;
   if ( v < 700 )
   {
     return v & 1 ? 0 : 0xff;
@@ -493,3 +505,11 @@ std::shared_ptr<ISuzyProcess> Suzy::suzyProcess()
 {
   return std::make_shared<SuzyProcess>( *this );
 }
+
+void Suzy::serialize( Snapshot & snapshot )
+{
+  snapshot.section( "SUZY" );
+  snapshot( mSCB, mAccessTick, mPalette, mBusEnable, mNoCollide, mVStretch, mLeftHand, mUnsafeAccess, mSpriteStop, mSpriteWorking, mHFlip, mVFlip,
+    mLiteral, mAlgo3, mReusePalette, mSkipSprite, mEveron, mStartingQuadrant, mBpp, mSpriteType, mReload, mSprColl, mSprInit, mNoiceSeed, mInput );
+  mMath.serialize( snapshot );
+}
@@ -4,6 +4,7 @@
 #include "SuzyMath.hpp"
 
 class Core;
+class Snapshot;
 
 class ISuzyProcess
 {
@@ -42,7 +43,7 @@ public:
 class Suzy
 {
 public:
-  Suzy( Core & core, std::shared_ptr<IInputSource> inputSource );
+  Suzy( Core & core, std::shared_ptr<IInputSource> inputSource, uint64_t seed );
 
   uint64_t requestRead( uint64_t tick, uint16_t address );
   uint64_t requestWrite( uint64_t tick, uint16_t address );
@@ -50,9 +51,14 @@ public:
   void write( uint16_t address, uint8_t value );
   uint16_t debugVidBas() const;
   uint16_t debugCollBas() const;
+  //samples input source. Registers return the last sample, so reading them costs no call to the source
+  void latchInput( uint64_t tick );
 
   std::shared_ptr<ISuzyProcess> suzyProcess();
 
+  //sprite engine registers only, SuzyProcess must not be running
+  void serialize( Snapshot & snapshot );
+
   friend class SuzyProcess;
 
   static constexpr uint16_t TMPADR    = 0x00;
@@ -340,6 +346,8 @@ private:
   Reload mReload;
   uint8_t mSprColl;
   uint8_t mSprInit; //should be 0xf3
+  uint64_t mNoiceSeed;
+  KeyInput mInput;
 
   static constexpr std::array<std::array<Quadrant, 4>,4> mQuadrantOrder ={
     std::array<Quadrant, 4>{ Quadrant::DOWN_RIGHT, Quadrant::UP_RIGHT, Quadrant::UP_LEFT, Quadrant::DOWN_LEFT },
@@ -2,6 +2,7 @@
 #include "SuzyMath.hpp"
 #include "TraceHelper.hpp"
 #include "Utility.hpp"
+#include "Snapshot.hpp"
 
 namespace
 {
@@ -286,4 +287,7 @@ void SuzyMath::np( uint16_t value )
   *( ( uint16_t* )( mArea.data() + off_np ) ) = value;
 }
 
-
+void SuzyMath::serialize( Snapshot & snapshot )
+{
+  snapshot( mArea, mFinishTick, mSignAB, mSignCD, mUnsafeAccess, mSignMath, mAccumulate, mMathWarning, mMathCarry );
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 class TraceHelper;
+class Snapshot;
 
 class SuzyMath
 {
@@ -26,6 +27,8 @@ public:
   void carry( bool value );
   void unsafeAccess( bool value );
 
+  void serialize( Snapshot & snapshot );
+
 private:
 
   uint32_t abcd() const;
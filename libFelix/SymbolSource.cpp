@@ -1,7 +1,16 @@
 #include "pch.hpp"
 #include "SymbolSource.hpp"
+#include "TraceHelper.hpp"
 
-SymbolSource::SymbolSource( std::filesystem::path const& labPath ) : mSymbols{}
+SymbolSource::SymbolSource( std::filesystem::path const& labPath ) : mTable{ load( labPath ) }
+{
+}
+
+SymbolSource::~SymbolSource()
+{
+}
+
+std::vector<SymbolTable::Symbol> SymbolSource::load( std::filesystem::path const& labPath )
 {
   std::ifstream fin{ labPath };
 
@@ -10,29 +19,41 @@ SymbolSource::SymbolSource( std::filesystem::path const& labPath ) : mSymbols{}
   std::getline( fin, line );
   std::getline( fin, line );
 
+  std::vector<SymbolTable::Symbol> symbols;
   while ( std::getline( fin, line ) && !line.empty() )
   {
     if ( auto symbol = parseLine( line ) )
     {
-      mSymbols.push_back( std::move( symbol ) );
+      symbols.push_back( std::move( *symbol ) );
     }
   }
+
+  return symbols;
 }
 
-SymbolSource::~SymbolSource()
+std::optional<uint16_t> SymbolSource::symbol( std::string const& name ) const
 {
+  return mTable.address( name );
 }
 
-std::optional<uint16_t> SymbolSource::symbol( std::string const& name ) const
+std::optional<std::string> SymbolSource::label( uint16_t value ) const
+{
+  auto labels = mTable.labels( value );
+
+  return labels.empty() ? std::optional<std::string>{} : std::string{ labels.front() };
+}
+
+void SymbolSource::applyLabels( TraceHelper & traceHelper ) const
 {
-  std::string upper;
-  std::transform( name.cbegin(), name.cend(), std::back_inserter( upper ), []( std::string::value_type c ) { return std::toupper( c ); } );
-  auto it = std::ranges::find( mSymbols, upper, &Symbol::name );
+  traceHelper.updateLabels( mTable );
+}
 
-  return it != mSymbols.cend() ? it->value : std::optional<uint16_t>{};
+SymbolTable const& SymbolSource::table() const
+{
+  return mTable;
 }
 
-SymbolSource::Symbol SymbolSource::parseLine( std::string const& line )
+std::optional<SymbolTable::Symbol> SymbolSource::parseLine( std::string const& line )
 {
   std::istringstream is{ line };
   std::string name;
@@ -40,8 +61,8 @@ SymbolSource::Symbol SymbolSource::parseLine( std::string const& line )
 
   is >> std::hex >> bank >> adr >> name;
 
-  if ( bank == 0 )
-    return { std::move( name ), (uint16_t)adr };
+  if ( bank == 0 && !name.empty() )
+    return SymbolTable::Symbol{ std::move( name ), (uint16_t)adr };
   else
     return {};
 }
@@ -1,26 +1,25 @@
 #pragma once
 
-class SymbolSource
-{
-  struct Symbol
-  {
-    std::string name;
-    uint16_t value;
+#include "SymbolTable.hpp"
 
-    explicit operator bool() const
-    {
-      return !name.empty();
-    }
-  };
+class TraceHelper;
 
+class SymbolSource
+{
 public:
   SymbolSource( std::filesystem::path const& labPath );
   ~SymbolSource();
   std::optional<uint16_t> symbol( std::string const& name ) const;
+  //first symbol with given value
+  std::optional<std::string> label( uint16_t value ) const;
+  //labels addresses in trace with symbol names
+  void applyLabels( TraceHelper & traceHelper ) const;
+  SymbolTable const& table() const;
 
 private:
-  Symbol parseLine( std::string const& line );
+  static std::vector<SymbolTable::Symbol> load( std::filesystem::path const& labPath );
+  static std::optional<SymbolTable::Symbol> parseLine( std::string const& line );
 
 private:
-  std::vector<Symbol> mSymbols;
+  SymbolTable mTable;
 };
@@ -0,0 +1,127 @@
+#include "pch.hpp"
+#include "SymbolTable.hpp"
+
+SymbolTable::SymbolTable() : SymbolTable{ std::span<Symbol const>{} }
+{
+}
+
+SymbolTable::SymbolTable( std::span<Symbol const> symbols ) : mPool{}, mEntries{}, mSlots{}, mOffsets( 65536 + 1 ), mAddressLabels{}, mContaining( 65536, NONE )
+{
+  size_t poolSize = 0;
+  for ( auto const& symbol : symbols )
+  {
+    poolSize += symbol.name.size();
+  }
+  //views into the pool stay valid as it never grows past this
+  mPool.reserve( poolSize );
+  mEntries.reserve( symbols.size() );
+  mSlots.assign( std::bit_ceil( std::max<size_t>( 16, symbols.size() * 2 ) ), NONE );
+
+  for ( auto const& symbol : symbols )
+  {
+    if ( symbol.name.empty() || symbol.size == 0 )
+      continue;
+
+    std::string_view name;
+    size_t s = slot( symbol.name, hash( symbol.name ) );
+    if ( mSlots[s] == NONE )
+    {
+      size_t begin = mPool.size();
+      mPool.insert( mPool.end(), symbol.name.cbegin(), symbol.name.cend() );
+      name = std::string_view{ mPool.data() + begin, symbol.name.size() };
+      mSlots[s] = (uint32_t)mEntries.size();
+    }
+    else
+    {
+      //interned, lookup by name finds the first one
+      name = mEntries[mSlots[s]].name;
+    }
+
+    mEntries.push_back( Entry{ name, symbol.address, std::min<uint32_t>( symbol.size, 0x10000 - symbol.address ) } );
+  }
+
+  //stable counting sort by address
+  for ( auto const& entry : mEntries )
+  {
+    mOffsets[entry.address + 1] += 1;
+  }
+  for ( size_t i = 1; i < mOffsets.size(); ++i )
+  {
+    mOffsets[i] += mOffsets[i - 1];
+  }
+  mAddressLabels.resize( mEntries.size() );
+  std::vector<uint32_t> cursor{ mOffsets.cbegin(), mOffsets.cend() - 1 };
+  for ( auto const& entry : mEntries )
+  {
+    mAddressLabels[cursor[entry.address]++] = entry.name;
+  }
+
+  //larger symbols first so that smaller ones nested in them win
+  std::vector<uint32_t> order;
+  order.reserve( mEntries.size() );
+  for ( uint32_t i = 0; i < mEntries.size(); ++i )
+  {
+    order.push_back( i );
+  }
+  std::ranges::stable_sort( order, std::greater{}, [this]( uint32_t i ) { return mEntries[i].size; } );
+  for ( uint32_t i : order )
+  {
+    auto const& entry = mEntries[i];
+    std::fill_n( mContaining.begin() + entry.address, entry.size, i );
+  }
+}
+
+std::optional<uint16_t> SymbolTable::address( std::string_view name ) const
+{
+  uint32_t index = mSlots[slot( name, hash( name ) )];
+
+  return index != NONE ? mEntries[index].address : std::optional<uint16_t>{};
+}
+
+std::span<std::string_view const> SymbolTable::labels( uint16_t address ) const
+{
+  return std::span<std::string_view const>{ mAddressLabels.data() + mOffsets[address], mAddressLabels.data() + mOffsets[address + 1] };
+}
+
+std::optional<std::pair<std::string_view, uint16_t>> SymbolTable::containing( uint16_t address ) const
+{
+  uint32_t index = mContaining[address];
+  if ( index == NONE )
+    return {};
+
+  auto const& entry = mEntries[index];
+  return std::make_pair( entry.name, (uint16_t)( address - entry.address ) );
+}
+
+size_t SymbolTable::size() const
+{
+  return mEntries.size();
+}
+
+uint32_t SymbolTable::hash( std::string_view name )
+{
+  //FNV-1a of upper case name
+  uint32_t result = 0x811c9dc5;
+  for ( char c : name )
+  {
+    result = ( result ^ (uint8_t)std::toupper( (uint8_t)c ) ) * 0x01000193;
+  }
+  return result;
+}
+
+bool SymbolTable::equal( std::string_view left, std::string_view right )
+{
+  return std::ranges::equal( left, right, []( char l, char r ) { return std::toupper( (uint8_t)l ) == std::toupper( (uint8_t)r ); } );
+}
+
+size_t SymbolTable::slot( std::string_view name, uint32_t hash ) const
+{
+  size_t mask = mSlots.size() - 1;
+  size_t s = hash & mask;
+  //table is at most half full so an empty slot is always found
+  while ( mSlots[s] != NONE && !equal( mEntries[mSlots[s]].name, name ) )
+  {
+    s = ( s + 1 ) & mask;
+  }
+  return s;
+}
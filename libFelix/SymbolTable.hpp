@@ -0,0 +1,57 @@
+#pragma once
+
+//Symbols built once in bulk with constant time lookups by name and by address.
+//Names are interned in a single pool, an address may have several labels and a symbol may cover a range of addresses.
+class SymbolTable
+{
+public:
+  struct Symbol
+  {
+    std::string name;
+    uint16_t address;
+    //number of addresses covered by the symbol
+    uint32_t size = 1;
+  };
+
+  SymbolTable();
+  explicit SymbolTable( std::span<Symbol const> symbols );
+  //names are views into the pool, which moves along with its buffer
+  SymbolTable( SymbolTable const& ) = delete;
+  SymbolTable( SymbolTable && ) = default;
+  SymbolTable & operator=( SymbolTable const& ) = delete;
+  SymbolTable & operator=( SymbolTable && ) = default;
+
+  //case insensitive, address of the first symbol with given name
+  std::optional<uint16_t> address( std::string_view name ) const;
+  //labels of address in load order
+  std::span<std::string_view const> labels( uint16_t address ) const;
+  //smallest symbol covering address and offset of address in it
+  std::optional<std::pair<std::string_view, uint16_t>> containing( uint16_t address ) const;
+  size_t size() const;
+
+private:
+  static constexpr uint32_t NONE = ~0u;
+
+  struct Entry
+  {
+    std::string_view name;
+    uint16_t address;
+    uint32_t size;
+  };
+
+  static uint32_t hash( std::string_view name );
+  static bool equal( std::string_view left, std::string_view right );
+  //index of entry with given name or of empty slot where it belongs
+  size_t slot( std::string_view name, uint32_t hash ) const;
+
+private:
+  std::vector<char> mPool;
+  std::vector<Entry> mEntries;
+  //open addressed name hash of entry indices, power of two sized
+  std::vector<uint32_t> mSlots;
+  //labels of address a are mAddressLabels[mOffsets[a]..mOffsets[a+1]]
+  std::vector<uint32_t> mOffsets;
+  std::vector<std::string_view> mAddressLabels;
+  //entry covering each address
+  std::vector<uint32_t> mContaining;
+};
@@ -1,5 +1,6 @@
 #include "pch.hpp"
 #include "TimerCore.hpp"
+#include "Snapshot.hpp"
 
 TimerCore::TimerCore( int number, std::function<void( uint64_t, bool )> trigger ) :
   mBaseTick{}, mExpectedTick{}, mBorrowInTick{}, mBorrowOutTick{}, mTrigger{ std::move( trigger ) }, mNumber{ number },
@@ -142,3 +143,9 @@ SequencedAction TimerCore::computeAction()
 
   return { (Action)( ( int )Action::FIRE_TIMER0 + mNumber ), mExpectedTick };
 }
+
+void TimerCore::serialize( Snapshot & snapshot )
+{
+  snapshot( mBaseTick, mExpectedTick, mBorrowInTick, mBorrowOutTick, mEnableInt, mResetDone, mEnableReload, mEnableCount, mLinking, mAudShift,
+    mValue, mBackup, mTimerDone, mLastClock, mBorrowIn, mBorrowOut );
+}
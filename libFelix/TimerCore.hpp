@@ -2,6 +2,8 @@
 
 #include "ActionQueue.hpp"
 
+class Snapshot;
+
 class TimerCore
 {
 public:
@@ -20,6 +22,8 @@ public:
   SequencedAction fireAction( uint64_t tick );
   void borrowIn( uint64_t tick );
 
+  void serialize( Snapshot & snapshot );
+
 private:
   SequencedAction computeAction();
   void updateValue( uint64_t tick );
@@ -1,5 +1,6 @@
 #include "pch.hpp"
 #include "TraceHelper.hpp"
+#include "SymbolTable.hpp"
 
 static constexpr int LABEL_SIZE_LIMIT = 20;
 
@@ -28,42 +29,28 @@ TraceHelper::~TraceHelper()
 {
 }
 
-void TraceHelper::updateLabel( uint16_t address, const char* label )
+void TraceHelper::updateLabel( uint16_t address, std::string_view label )
 {
-  if ( address > 0xffff )
+  if ( label.empty() || label.size() > LABEL_SIZE_LIMIT )
   {
     return;
   }
 
-  auto labelLen = strlen( label );
-  if ( labelLen <= 0 || labelLen > LABEL_SIZE_LIMIT )
-  {
-    return;
-  }
-
-  auto currPos = mLabels[address];
-
-  std::vector<char>::iterator iterFirst = mData.begin() + currPos;
-  auto iterLast = iterFirst;
+  mLabels[address] = (uint32_t)mData.size();
+  mData.insert( mData.end(), label.cbegin(), label.cend() );
+  mData.push_back( '\0' );
+}
 
-  while ( *iterLast != 0 )
-  {
-    iterLast += 1;
-    labelLen--;
-  }
+void TraceHelper::updateLabels( SymbolTable const& table )
+{
+  mData.reserve( mData.size() + table.size() * ( LABEL_SIZE_LIMIT + 1 ) );
 
-  mData.erase( iterFirst, iterLast );
-  
-  iterFirst = mData.begin() + currPos;
-  for ( int i = 0; i < strlen( label ); ++i )
+  for ( size_t i = 0; i < mLabels.size(); ++i )
   {
-    iterFirst = mData.insert( iterFirst, label[i]) + 1;
+    auto labels = table.labels( (uint16_t)i );
+    if ( !labels.empty() )
+      updateLabel( (uint16_t)i, labels.front() );
   }
-  
-  do 
-  {
-    mLabels[++address] += (uint32_t)labelLen;
-  } while ( address < 0xffff );
 }
 
 char const * TraceHelper::addressLabel( uint16_t address ) const
@@ -13,13 +13,17 @@ struct StaticString
   }
 };
 
+class SymbolTable;
+
 class TraceHelper
 {
 public:
   TraceHelper();
   ~TraceHelper();
   char const * addressLabel( uint16_t address ) const;
-  void updateLabel( uint16_t address, const char* label );
+  void updateLabel( uint16_t address, std::string_view label );
+  //first label of each address in the table
+  void updateLabels( SymbolTable const& table );
 
   void enable( bool cond );
 
@@ -42,6 +46,7 @@ private:
   char const * map( uint16_t address, char * dest ) const;
 
 private:
+  //offsets of labels in mData. Replaced labels are left behind, so updates only append
   std::array<uint32_t, 65536> mLabels;
   std::array<char, 1024> mTraceComment;
   std::vector<char> mData;
@@ -0,0 +1,100 @@
+#include "pch.hpp"
+#include "WriteMonitor.hpp"
+
+WriteMonitor::WriteMonitor() : mMutex{}, mWatches{}, mNextId{ 1 }, mSequence{}, mBitmap{}
+{
+}
+
+uint32_t WriteMonitor::watch( uint16_t address, uint16_t size )
+{
+  std::scoped_lock<std::mutex> l{ mMutex };
+
+  uint32_t id = mNextId++;
+  //range does not wrap around
+  mWatches.push_back( Watch{ id, address, (uint16_t)std::min<uint32_t>( size, 0x10000 - address ), ++mSequence, {}, 0 } );
+  updateBitmap();
+  return id;
+}
+
+void WriteMonitor::unwatch( uint32_t id )
+{
+  std::scoped_lock<std::mutex> l{ mMutex };
+
+  std::erase_if( mWatches, [id]( Watch const& watch ) { return watch.id == id; } );
+  updateBitmap();
+}
+
+void WriteMonitor::invalidate()
+{
+  std::scoped_lock<std::mutex> l{ mMutex };
+
+  mSequence += 1;
+  for ( auto & watch : mWatches )
+  {
+    watch.version = mSequence;
+  }
+}
+
+uint64_t WriteMonitor::version( uint32_t id ) const
+{
+  std::scoped_lock<std::mutex> l{ mMutex };
+
+  auto it = std::ranges::find( mWatches, id, &Watch::id );
+  return it != mWatches.cend() ? it->version : 0;
+}
+
+uint64_t WriteMonitor::sequence() const
+{
+  std::scoped_lock<std::mutex> l{ mMutex };
+
+  return mSequence;
+}
+
+std::vector<WriteMonitor::Write> WriteMonitor::history( uint32_t id ) const
+{
+  std::scoped_lock<std::mutex> l{ mMutex };
+
+  std::vector<Write> result;
+  auto it = std::ranges::find( mWatches, id, &Watch::id );
+  if ( it == mWatches.cend() )
+    return result;
+
+  uint64_t first = it->writes > HISTORY_SIZE ? it->writes - HISTORY_SIZE : 0;
+  for ( uint64_t i = first; i < it->writes; ++i )
+  {
+    result.push_back( it->history[i % HISTORY_SIZE] );
+  }
+  return result;
+}
+
+void WriteMonitor::record( Write const& write )
+{
+  std::scoped_lock<std::mutex> l{ mMutex };
+
+  mSequence += 1;
+  for ( auto & watch : mWatches )
+  {
+    if ( write.address >= watch.address && write.address < watch.address + watch.size )
+    {
+      watch.version = mSequence;
+      watch.history[watch.writes++ % HISTORY_SIZE] = write;
+    }
+  }
+}
+
+void WriteMonitor::updateBitmap()
+{
+  std::array<uint64_t, 65536 / 64> bitmap{};
+  for ( auto const& watch : mWatches )
+  {
+    for ( uint32_t address = watch.address; address < watch.address + watch.size; ++address )
+    {
+      bitmap[address >> 6] |= 1ull << ( address & 63 );
+    }
+  }
+
+  for ( size_t i = 0; i < bitmap.size(); ++i )
+  {
+    mBitmap[i].store( bitmap[i], std::memory_order_relaxed );
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+//Observes writes to watched RAM ranges.
+//A bitmap of watched addresses keeps unwatched writes at one test whatever the number of watches.
+//Each watch counts writes to its range and keeps the latest ones with the tick and instruction of the writer.
+class WriteMonitor
+{
+public:
+  static constexpr size_t HISTORY_SIZE = 16;
+
+  enum class Source : uint8_t
+  {
+    CPU,
+    SUZY,
+    DEBUGGER
+  };
+
+  struct Write
+  {
+    uint64_t tick;
+    //instruction writing or being executed when Suzy writes
+    uint16_t pc;
+    uint16_t address;
+    uint8_t value;
+    Source source;
+  };
+
+  WriteMonitor();
+
+  //returns id of watch of size bytes from address
+  uint32_t watch( uint16_t address, uint16_t size );
+  void unwatch( uint32_t id );
+  //marks all watches changed, e.g. when state is restored
+  void invalidate();
+
+  void write( uint16_t address, uint8_t value, uint64_t tick, uint16_t pc, Source source )
+  {
+    if ( mBitmap[address >> 6].load( std::memory_order_relaxed ) & ( 1ull << ( address & 63 ) ) )
+      record( Write{ tick, pc, address, value, source } );
+  }
+
+  //sequence of the latest change of watched range, 0 for unknown watch
+  uint64_t version( uint32_t id ) const;
+  //sequence of the latest change of any watch
+  uint64_t sequence() const;
+  //oldest write first
+  std::vector<Write> history( uint32_t id ) const;
+
+private:
+  struct Watch
+  {
+    uint32_t id;
+    uint16_t address;
+    uint16_t size;
+    uint64_t version;
+    std::array<Write, HISTORY_SIZE> history;
+    //number of writes ever recorded
+    uint64_t writes;
+  };
+
+  void record( Write const& write );
+  void updateBitmap();
+
+private:
+  mutable std::mutex mMutex;
+  std::vector<Watch> mWatches;
+  uint32_t mNextId;
+  uint64_t mSequence;
+  std::array<std::atomic<uint64_t>, 65536 / 64> mBitmap;
+};